@@ -0,0 +1,251 @@
+// Bitmap_Allocator.hpp
+//
+// Description:
+//   A lock-free hierarchical bitmap allocator for the IDs and the slot indices
+//   (e.g. connection IDs, buffer indices and handles):
+//     Level 0 (leaves) : one bit per ID (1: allocated, 0: free)
+//     Level 1 (summary): one bit per leaf word (1: the leaf word is full)
+//   The summary level allows skipping 64 full leaf words with a single load
+//   while searching for the first free ID.
+//
+// Requirements:
+// - Capacity_As_Pow2 >= 6 (i.e. at least a single 64-bit leaf word).
+//
+// Invariants:
+//   1. An ID is owned by a thread iff the thread has set its leaf bit by fetch_or.
+//   2. The summary bits are hints:
+//        a cleared summary bit may refer to a full leaf word (a failed trial),
+//        a set summary bit refers to a full leaf word eventually
+//        (see the correction in allocate and deallocate below).
+//
+// Semantics:
+//   allocate():
+//     1. Start from the thread local hint cursor
+//        (initialized by the hashed thread id to spread the threads over the bitmap)
+//     2. Skip the leaf words marked as full in the summary level
+//     3. Find the first zero bit of the leaf word: std::countr_one(leaf)
+//     4. Claim the bit by fetch_or and retry the word if another thread was faster
+//     5. If the leaf word became full, set its summary bit
+//        and re-check the leaf word in order to correct a concurrent deallocate
+//     6. Store the hint cursor and return the ID
+//   allocate(partition):
+//     Same as allocate() but searches the leaf words of the partition first
+//     and falls back to the other partitions in order.
+//     The partitions split the leaf words evenly (e.g. one partition per NUMA node).
+//   deallocate(id):
+//     1. Clear the bit by fetch_and
+//     2. If the leaf word was full, clear its summary bit
+//
+// Progress:
+//   Lock-free:
+//     A failed fetch_or trial means another thread has allocated an ID.
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      acquire the data protected by an ID while allocating and
+//      to release the data protected by an ID while deallocating.
+//   2. The summary bit of a full leaf word is set and cleared by seq_cst RMWs
+//      and the leaf word is re-checked by a seq_cst load after setting it.
+//      Otherwise, allocate (set the summary bit, load the leaf word) and
+//      deallocate (clear the leaf bit, clear the summary bit) may miss each other
+//      (a store buffering) leaving the summary bit set over a leaf word with free IDs
+//      which would be skipped forever.
+//      The summary bits are read relaxed while searching as they are hints.
+//   3. The per-thread hint cursor keeps the threads on different leaf words
+//      avoiding the contention on the same cache line.
+//   4. The allocator can back the registries and the pools of this library
+//      (e.g. a dynamic hazard pointer registry) where a slot index is required.
+//
+// Cautions:
+//   1. Deallocating an ID which is not allocated breaks the invariants.
+//   2. The hint cursor is thread local per template instantiation
+//      and is shared by the allocators with the same capacity.
+//      It is only a starting point for the search.
+//
+// TODOs:
+//   1. Consider a third level for the very large capacities.
+
+#ifndef BITMAP_ALLOCATOR_HPP
+#define BITMAP_ALLOCATOR_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <bit>
+#include <thread>
+#include <optional>
+#include <functional>
+#include <algorithm>
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    template <unsigned char Capacity_As_Pow2>
+    requires (Capacity_As_Pow2 >= 6)
+    class Bitmap_Allocator {
+        static constexpr std::size_t _BITS          = 64;
+        static constexpr std::uint64_t _FULL        = ~std::uint64_t{0};
+        static constexpr std::size_t _CAPACITY      = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::size_t _LEAF_COUNT    = _CAPACITY / _BITS;
+        static constexpr std::size_t _SUMMARY_COUNT = (_LEAF_COUNT + _BITS - 1) / _BITS;
+
+        // the thread local hint cursor (a leaf word index)
+        static std::size_t& hint() noexcept {
+            static thread_local std::size_t hint_ =
+                std::hash<std::thread::id>{}(std::this_thread::get_id()) % _LEAF_COUNT;
+            return hint_;
+        }
+
+        static constexpr std::uint64_t bit(std::size_t index) noexcept {
+            return std::uint64_t{1} << (index % _BITS);
+        }
+
+        // Step 5 of allocate
+        void mark_full(std::size_t leaf_index) noexcept {
+            auto& summary = _summary[leaf_index / _BITS];
+            summary.fetch_or(bit(leaf_index), std::memory_order_seq_cst);
+
+            // a concurrent deallocate may have cleared a bit of the leaf word
+            // before the summary bit is set (see Notes 2)
+            if (_leaves[leaf_index].value.load(std::memory_order_seq_cst) != _FULL)
+                summary.fetch_and(~bit(leaf_index), std::memory_order_seq_cst);
+        }
+
+        // Steps 3 and 4 of allocate:
+        // claim a free bit of the leaf word if exists any
+        std::optional<std::size_t> try_allocate_in_leaf(std::size_t leaf_index) noexcept {
+            auto& leaf = _leaves[leaf_index].value;
+            std::uint64_t bits = leaf.load(std::memory_order_relaxed);
+            while (bits != _FULL) {
+                // Step 3
+                const std::uint64_t mask = std::uint64_t{1} << std::countr_one(bits);
+
+                // Step 4
+                bits = leaf.fetch_or(mask, std::memory_order_acquire);
+                if (bits & mask) continue; // another thread was faster
+
+                // Step 5
+                if ((bits | mask) == _FULL) mark_full(leaf_index);
+
+                return leaf_index * _BITS + std::countr_zero(mask);
+            }
+            return std::nullopt;
+        }
+
+        // search the leaf words [first_leaf, last_leaf) starting from the start leaf
+        std::optional<std::size_t> allocate_in_range(
+            std::size_t first_leaf,
+            std::size_t last_leaf,
+            std::size_t start_leaf) noexcept
+        {
+            const std::size_t leaf_count = last_leaf - first_leaf;
+            if (leaf_count == 0) return std::nullopt;
+
+            std::size_t offset = (start_leaf - first_leaf) % leaf_count;
+            for (std::size_t visited = 0; visited < leaf_count; ) {
+                const std::size_t leaf_index = first_leaf + offset;
+
+                // Step 2: skip the full leaf words
+                const std::uint64_t summary =
+                    _summary[leaf_index / _BITS].load(std::memory_order_relaxed) >> (leaf_index % _BITS);
+                std::size_t skip = static_cast<std::size_t>(std::countr_one(summary));
+                if (skip == 0) {
+                    if (auto id = try_allocate_in_leaf(leaf_index); id.has_value()) {
+                        // Step 6
+                        hint() = leaf_index;
+                        return id;
+                    }
+                    skip = 1;
+                }
+
+                skip = std::min(skip, last_leaf - leaf_index); // do not cross the range
+                visited += skip;
+                offset = (offset + skip) % leaf_count;
+            }
+            return std::nullopt;
+        }
+
+    public:
+
+        // partition_count: the number of the partitions (e.g. the NUMA nodes)
+        //                  sharing the capacity evenly
+        explicit Bitmap_Allocator(std::size_t partition_count = 1) noexcept
+            : _partition_count(std::clamp<std::size_t>(partition_count, 1, _LEAF_COUNT)) {}
+
+        // Non-copyable/movable for simplicity
+        Bitmap_Allocator(const Bitmap_Allocator&) = delete;
+        Bitmap_Allocator& operator=(const Bitmap_Allocator&) = delete;
+        Bitmap_Allocator(Bitmap_Allocator&&) = delete;
+        Bitmap_Allocator& operator=(Bitmap_Allocator&&) = delete;
+
+        // allocate an ID starting from the thread local hint cursor.
+        // returns std::nullopt if all IDs are allocated.
+        std::optional<std::size_t> allocate() noexcept {
+            return allocate_in_range(0, _LEAF_COUNT, hint());
+        }
+
+        // allocate an ID from the partition first and
+        // fall back to the other partitions in order.
+        // returns std::nullopt if all IDs are allocated.
+        std::optional<std::size_t> allocate(std::size_t partition) noexcept {
+            partition %= _partition_count;
+            for (std::size_t i = 0; i < _partition_count; ++i) {
+                const std::size_t p = (partition + i) % _partition_count;
+                const std::size_t first_leaf = first_leaf_of(p);
+                const std::size_t last_leaf = first_leaf_of(p + 1);
+                const std::size_t start_leaf =
+                    first_leaf + hint() % (last_leaf - first_leaf);
+                if (auto id = allocate_in_range(first_leaf, last_leaf, start_leaf); id.has_value())
+                    return id;
+            }
+            return std::nullopt;
+        }
+
+        // deallocate an allocated ID
+        //   1. Clear the bit by fetch_and
+        //   2. If the leaf word was full, clear its summary bit
+        void deallocate(std::size_t id) noexcept {
+            assert(id < _CAPACITY);
+            const std::size_t leaf_index = id / _BITS;
+
+            // Step 1
+            const std::uint64_t bits =
+                _leaves[leaf_index].value.fetch_and(~bit(id), std::memory_order_release);
+            assert(bits & bit(id));
+
+            // Step 2 (see Notes 2)
+            if (bits == _FULL)
+                _summary[leaf_index / _BITS].fetch_and(~bit(leaf_index), std::memory_order_seq_cst);
+        }
+
+        bool is_allocated(std::size_t id) const noexcept {
+            return _leaves[id / _BITS].value.load(std::memory_order_acquire) & bit(id);
+        }
+
+        // the IDs of the partition are in [first_id_of(partition), first_id_of(partition + 1))
+        std::size_t first_id_of(std::size_t partition) const noexcept {
+            return first_leaf_of(partition) * _BITS;
+        }
+
+        inline std::size_t partition_count() const noexcept { return _partition_count; }
+
+        static constexpr std::size_t capacity() noexcept { return _CAPACITY; }
+
+    private:
+
+        std::size_t first_leaf_of(std::size_t partition) const noexcept {
+            return partition * _LEAF_COUNT / _partition_count;
+        }
+
+        // MEMBERS:
+        // The leaf words are cache line aligned
+        // as the threads working on different leaf words shall not interfere.
+        // The summary words are read mostly.
+        cache_line_wrapper<std::atomic<std::uint64_t>> _leaves[_LEAF_COUNT]{};
+        std::atomic<std::uint64_t> _summary[_SUMMARY_COUNT]{};
+        std::size_t _partition_count;
+    };
+} // namespace BA_Concurrency
+
+#endif // BITMAP_ALLOCATOR_HPP
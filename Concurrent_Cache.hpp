@@ -0,0 +1,445 @@
+// Concurrent_Cache.hpp
+//
+// Description:
+//   A concurrent key-value cache with lock-free lookups
+//   which fronts a slow store shared by all workers of a pool:
+//     1. The lookups (find) are lock-free and do not write the entry or the shard on a hot key.
+//        A lookup writes only the hazard ptr record of its thread (see Cautions 3).
+//     2. The inserts are sharded: a mutex per shard serializes the writers of the shard only.
+//     3. The eviction follows the CLOCK algorithm (a referenced bit per entry)
+//        instead of an LRU list which would serialize the readers on the list lock.
+//     4. The admission follows TinyLFU:
+//        a new entry replaces the CLOCK victim only if it is accessed more frequently.
+//     5. The capacity is measured in bytes by a user defined weigher.
+//     6. The evicted entries are reclaimed through the hazard pointers.
+//
+// Requirements:
+// - Key must be equality comparable and hashable by Hash.
+// - Value must be copy constructible (find returns a copy).
+//
+// Design:
+//   Entry:
+//     Immutable key and value together with:
+//       _hash      : the hash of the key
+//       _bytes     : the weight of the entry
+//       _referenced: the CLOCK bit set by the lookups
+//     An update replaces the entry instead of modifying it in place.
+//     Hence, a reader protecting an entry reads a consistent key-value pair.
+//
+//   Shard:
+//     _slots     : open addressing index (linear probing) of atomic entry ptrs
+//     _m         : the mutex of the writers
+//     _sketch    : the TinyLFU frequency sketch (count-min sketch of 4-bit counters)
+//     _clock_hand: the CLOCK hand over the slots
+//     _bytes     : the total weight of the entries
+//
+//   The shard of a key is selected by the low bits of the hash
+//   and the home slot by the remaining bits.
+//
+// Semantics:
+//   find(key):
+//     1. Probe the slots starting from the home slot until an empty slot
+//     2. Protect the entry in the slot by a hazard ptr
+//        and re-load the slot to validate that the entry is not removed yet
+//     3. If the key matches:
+//          Set the CLOCK bit and increment the frequency sketch
+//          only if the CLOCK bit is not already set (a hot key does not write the entry or the sketch)
+//          Return a copy of the value
+//     4. Clear the hazard ptr (the record is kept by the thread for the next lookup)
+//   insert(key, value):
+//     1. Lock the shard
+//     2. If the key exists, replace the entry and retire the old entry
+//     3. Increment the frequency sketch and age it if a sample of increments is completed
+//     4. While the shard exceeds its bytes or its slot budget:
+//          Select the victim by the CLOCK hand (clear the referenced bits on the way)
+//          TinyLFU admission: reject the new entry if not more frequent than the victim
+//          Remove the victim (backward shift deletion) and retire it via the hazard ptrs
+//     5. Store the new entry into the first empty slot of the probe sequence
+//   erase(key):
+//     Lock the shard, remove the entry (backward shift deletion) and retire it.
+//
+// Progress:
+//   find   : lock-free
+//   insert : blocking on the shard mutex
+//   erase  : blocking on the shard mutex
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release an entry before publishing it in a slot and
+//      to acquire an entry after observing it in a slot.
+//      The hazard ptr publication and the validating re-load are separated
+//      by a sequentially consistent fence (store-load ordering).
+//   2. The backward shift deletion moves the entries towards their home slots.
+//      A concurrent lookup may miss a moving entry.
+//      A false miss is acceptable for a cache (the value is loaded from the store).
+//   3. The load factor of a shard is bounded by 1/2
+//      in order to keep the probe sequences short.
+//
+// Cautions:
+//   1. The retired entries are reclaimed per thread (see Hazard_Ptr.hpp).
+//   2. Value is copied under the hazard ptr protection.
+//      Use a cheap-to-copy Value (e.g. std::shared_ptr) for the large objects.
+//   3. The cost of a lookup on a hot key is not zero writes:
+//      the hazard ptr record of the thread is published per probed entry and cleared at the end
+//      and a sequentially consistent fence follows each publication.
+//      The record is padded to a cache line and read by the reclamation scans only.
+//      A lookup on a cold key additionally writes 4 counters of the shared sketch.
+//      The record is acquired by the first lookup of the thread (exclusive, see Hazard_Ptr.hpp Semantics 7)
+//      and released at the thread exit.
+//      Hence, each thread calling find holds a hazard ptr record for its lifetime
+//      and the threads are bounded by Hazard_Ptr_Record_Count (exceeding it terminates).
+//
+// TODOs:
+//   1. Consider a doorkeeper bloom filter in front of the sketch (W-TinyLFU).
+
+#ifndef CONCURRENT_CACHE_HPP
+#define CONCURRENT_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "aux_type_traits.hpp"
+#include "Hazard_Ptr.hpp"
+
+namespace BA_Concurrency {
+    // the default weigher: the shallow size of the key-value pair
+    template <typename Key, typename Value>
+    struct Cache_Weigher {
+        std::size_t operator()(const Key&, const Value&) const noexcept {
+            return sizeof(Key) + sizeof(Value);
+        }
+    };
+
+    template <
+        typename Key,
+        typename Value,
+        typename Hash = std::hash<Key>,
+        typename Weigher = Cache_Weigher<Key, Value>,
+        unsigned char Shard_Count_As_Pow2 = 4,
+        unsigned char Slot_Count_As_Pow2 = 12,
+        std::size_t Hazard_Ptr_Record_Count = HAZARD_PTR_RECORD_COUNT__DEFAULT>
+    requires (
+            std::is_copy_constructible_v<Value> &&
+            Slot_Count_As_Pow2 >= 2)
+    class Concurrent_Cache {
+        static constexpr std::size_t _SHARD_COUNT = pow2_size<Shard_Count_As_Pow2>;
+        static constexpr std::size_t _SHARD_MASK  = _SHARD_COUNT - 1;
+        static constexpr std::size_t _SLOT_COUNT  = pow2_size<Slot_Count_As_Pow2>;
+        static constexpr std::size_t _SLOT_MASK   = _SLOT_COUNT - 1;
+        static constexpr std::size_t _MAX_ENTRY_COUNT = _SLOT_COUNT / 2;
+
+        // local aliases
+        using _HPO = Hazard_Ptr_Owner<Hazard_Ptr_Record_Count>;
+
+        struct Entry {
+            const Key _key;
+            const Value _value;
+            const std::size_t _hash;
+            const std::size_t _bytes;
+            std::atomic<bool> _referenced{ false };
+        };
+
+        // The count-min sketch of TinyLFU:
+        //   4 rows of saturating 4-bit counters (stored in bytes for the atomic access).
+        //   All counters are halved after a sample of increments (aging).
+        //   The aging is performed by the writers of the shard (not on the lookup path).
+        class Frequency_Sketch {
+            static constexpr std::size_t _ROW_COUNT    = 4;
+            static constexpr std::uint8_t _MAX_COUNTER = 15;
+            static constexpr std::size_t _SAMPLE_SIZE  = 10 * _SLOT_COUNT;
+            static constexpr std::uint64_t _SEEDS[_ROW_COUNT]{
+                0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL,
+                0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL };
+
+            static std::size_t index(std::size_t hash, std::size_t row) noexcept {
+                std::uint64_t h = (static_cast<std::uint64_t>(hash) + _SEEDS[row]) * _SEEDS[row];
+                return static_cast<std::size_t>(h >> 32) & _SLOT_MASK;
+            }
+
+            std::atomic<std::uint8_t> _counters[_ROW_COUNT][_SLOT_COUNT]{};
+            std::atomic<std::size_t> _increment_count{ 0 };
+
+        public:
+
+            void increment(std::size_t hash) noexcept {
+                for (std::size_t row = 0; row < _ROW_COUNT; ++row) {
+                    auto& counter = _counters[row][index(hash, row)];
+                    if (const auto c = counter.load(std::memory_order_relaxed); c < _MAX_COUNTER)
+                        counter.store(c + 1, std::memory_order_relaxed);
+                }
+                _increment_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // halve all counters if a sample of increments is completed.
+            // the caller holds the shard mutex.
+            // the concurrent increments may be lost which is acceptable for a sketch.
+            void age_if_sampled() noexcept {
+                if (_increment_count.load(std::memory_order_relaxed) < _SAMPLE_SIZE) return;
+                _increment_count.fetch_sub(_SAMPLE_SIZE, std::memory_order_relaxed);
+                for (auto& row : _counters)
+                    for (auto& counter : row)
+                        counter.store(
+                            counter.load(std::memory_order_relaxed) >> 1,
+                            std::memory_order_relaxed);
+            }
+
+            std::uint8_t estimate(std::size_t hash) const noexcept {
+                std::uint8_t frequency{ _MAX_COUNTER };
+                for (std::size_t row = 0; row < _ROW_COUNT; ++row)
+                    frequency = std::min(
+                        frequency,
+                        _counters[row][index(hash, row)].load(std::memory_order_relaxed));
+                return frequency;
+            }
+        };
+
+        struct alignas(64) Shard {
+            std::atomic<Entry*> _slots[_SLOT_COUNT]{};
+            std::mutex _m;
+            Frequency_Sketch _sketch;
+            std::size_t _clock_hand{};
+            std::size_t _entry_count{};
+            std::atomic<std::size_t> _bytes{ 0 };
+        };
+
+        // deleter to be supplied to Hazard_Ptr_Owner for deferred reclamation
+        static void delete_entry(void *ptr, void *) {
+            delete static_cast<Entry*>(ptr);
+        }
+
+        static void retire(Entry* entry) {
+            std::atomic_thread_fence(std::memory_order_seq_cst); // the slot update before the hazard ptr scan
+            _HPO::reclaim_memory_later(static_cast<void*>(entry), nullptr, &delete_entry);
+        }
+
+        static std::size_t home_slot(std::size_t hash) noexcept {
+            return (hash >> Shard_Count_As_Pow2) & _SLOT_MASK;
+        }
+
+        Shard& shard_of(std::size_t hash) const noexcept {
+            return _shards[hash & _SHARD_MASK];
+        }
+
+        // the slot index of the key or _SLOT_COUNT if not found.
+        // the caller holds the shard mutex.
+        static std::size_t find_slot(Shard& shard, std::size_t hash, const Key& key) noexcept {
+            std::size_t slot_index = home_slot(hash);
+            for (std::size_t probe = 0; probe < _SLOT_COUNT; ++probe) {
+                Entry* entry = shard._slots[slot_index].load(std::memory_order_relaxed);
+                if (!entry) break;
+                if (entry->_hash == hash && entry->_key == key) return slot_index;
+                slot_index = (slot_index + 1) & _SLOT_MASK;
+            }
+            return _SLOT_COUNT;
+        }
+
+        // remove the entry in the slot by the backward shift deletion.
+        // the caller holds the shard mutex and retires the removed entry.
+        static Entry* remove_slot(Shard& shard, std::size_t slot_index) noexcept {
+            Entry* removed = shard._slots[slot_index].load(std::memory_order_relaxed);
+            std::size_t hole = slot_index;
+            std::size_t next = slot_index;
+            while (true) {
+                next = (next + 1) & _SLOT_MASK;
+                Entry* entry = shard._slots[next].load(std::memory_order_relaxed);
+                if (!entry) break;
+
+                // the entry stays if its home slot is cyclically in (hole, next]
+                const std::size_t home = home_slot(entry->_hash);
+                const bool stays =
+                    hole <= next ?
+                    hole < home && home <= next :
+                    hole < home || home <= next;
+                if (stays) continue;
+
+                // copy first and clear later: a reader may see the entry twice but not a freed one
+                shard._slots[hole].store(entry, std::memory_order_release);
+                hole = next;
+            }
+            shard._slots[hole].store(nullptr, std::memory_order_release);
+            --shard._entry_count;
+            shard._bytes.fetch_sub(removed->_bytes, std::memory_order_relaxed);
+            return removed;
+        }
+
+        // select the CLOCK victim clearing the referenced bits on the way.
+        // the caller holds the shard mutex and the shard is not empty.
+        static std::size_t select_victim(Shard& shard) noexcept {
+            while (true) {
+                const std::size_t slot_index = shard._clock_hand;
+                shard._clock_hand = (shard._clock_hand + 1) & _SLOT_MASK;
+                Entry* entry = shard._slots[slot_index].load(std::memory_order_relaxed);
+                if (!entry) continue;
+                if (entry->_referenced.exchange(false, std::memory_order_relaxed)) continue;
+                return slot_index;
+            }
+        }
+
+    public:
+
+        explicit Concurrent_Cache(std::size_t capacity_in_bytes, Weigher weigher = Weigher{})
+            : _shard_capacity(capacity_in_bytes / _SHARD_COUNT)
+            , _weigher(std::move(weigher))
+            , _shards(std::make_unique<Shard[]>(_SHARD_COUNT)) {}
+
+        // Single-threaded context expected.
+        ~Concurrent_Cache() {
+            for (std::size_t i = 0; i < _SHARD_COUNT; ++i)
+                for (auto& slot : _shards[i]._slots)
+                    delete slot.load(std::memory_order_relaxed);
+
+            // TODO:
+            //   Defered reclamation is per thread base (see Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp).
+            _HPO::try_reclaim_memory();
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Cache(const Concurrent_Cache&) = delete;
+        Concurrent_Cache& operator=(const Concurrent_Cache&) = delete;
+        Concurrent_Cache(Concurrent_Cache&&) = delete;
+        Concurrent_Cache& operator=(Concurrent_Cache&&) = delete;
+
+        // lock-free lookup:
+        //   1. Probe the slots starting from the home slot until an empty slot
+        //   2. Protect the entry by a hazard ptr and validate the slot
+        //   3. If the key matches, set the CLOCK bit and copy the value
+        //   4. Clear the hazard ptr and return the copy
+        std::optional<Value> find(const Key& key) const {
+            const std::size_t hash = Hash{}(key);
+            Shard& shard = shard_of(hash);
+
+            // the record of the thread is acquired once (see Cautions 3)
+            static thread_local const _HPO hazard_ptr_owner{ Hazard_Ptr_Exclusive{} };
+            std::optional<Value> value;
+
+            // Step 1
+            std::size_t slot_index = home_slot(hash);
+            for (std::size_t probe = 0; probe < _SLOT_COUNT; ) {
+                Entry* entry = shard._slots[slot_index].load(std::memory_order_acquire);
+                if (!entry) break;
+
+                // Step 2
+                hazard_ptr_owner.protect(entry);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (shard._slots[slot_index].load(std::memory_order_acquire) != entry) continue;
+
+                // Step 3
+                if (entry->_hash == hash && entry->_key == key) {
+                    if (!entry->_referenced.load(std::memory_order_relaxed)) {
+                        entry->_referenced.store(true, std::memory_order_relaxed);
+                        shard._sketch.increment(hash);
+                    }
+                    try { value.emplace(entry->_value); }
+                    catch (...) { hazard_ptr_owner.clear(); throw; }
+                    break;
+                }
+                slot_index = (slot_index + 1) & _SLOT_MASK;
+                ++probe;
+            }
+
+            // Step 4
+            hazard_ptr_owner.clear();
+            return value;
+        }
+
+        // sharded insert with TinyLFU admission.
+        // returns false if the entry is rejected.
+        //   1. Lock the shard
+        //   2. If the key exists, replace the entry and retire the old entry
+        //   3. Increment the frequency sketch and age it if a sample of increments is completed
+        //   4. Evict the CLOCK victims until the entry fits (TinyLFU admission)
+        //   5. Store the new entry into the first empty slot of the probe sequence
+        bool insert(Key key, Value value) {
+            const std::size_t hash = Hash{}(key);
+            const std::size_t bytes = _weigher(key, value);
+            if (bytes > _shard_capacity) return false;
+            Shard& shard = shard_of(hash);
+
+            // Step 1
+            std::scoped_lock lk(shard._m);
+
+            // Step 2
+            if (const std::size_t slot_index = find_slot(shard, hash, key); slot_index != _SLOT_COUNT) {
+                Entry* old_entry = shard._slots[slot_index].load(std::memory_order_relaxed);
+                if (
+                    shard._bytes.load(std::memory_order_relaxed) - old_entry->_bytes + bytes >
+                    _shard_capacity)
+                {
+                    // evict the old entry and continue as a new entry
+                    retire(remove_slot(shard, slot_index));
+                }
+                else {
+                    Entry* entry = new Entry{ std::move(key), std::move(value), hash, bytes };
+                    entry->_referenced.store(true, std::memory_order_relaxed);
+                    shard._slots[slot_index].store(entry, std::memory_order_release);
+                    shard._bytes.fetch_add(bytes - old_entry->_bytes, std::memory_order_relaxed);
+                    retire(old_entry);
+                    return true;
+                }
+            }
+
+            // Step 3
+            shard._sketch.increment(hash);
+            shard._sketch.age_if_sampled();
+
+            // Step 4
+            while (
+                shard._entry_count == _MAX_ENTRY_COUNT ||
+                shard._bytes.load(std::memory_order_relaxed) + bytes > _shard_capacity)
+            {
+                const std::size_t victim_slot = select_victim(shard);
+                Entry* victim = shard._slots[victim_slot].load(std::memory_order_relaxed);
+                if (shard._sketch.estimate(hash) <= shard._sketch.estimate(victim->_hash))
+                    return false; // TinyLFU admission rejects the new entry
+                retire(remove_slot(shard, victim_slot));
+            }
+
+            // Step 5
+            Entry* entry = new Entry{ std::move(key), std::move(value), hash, bytes };
+            std::size_t slot_index = home_slot(hash);
+            while (shard._slots[slot_index].load(std::memory_order_relaxed))
+                slot_index = (slot_index + 1) & _SLOT_MASK;
+            shard._slots[slot_index].store(entry, std::memory_order_release);
+            ++shard._entry_count;
+            shard._bytes.fetch_add(bytes, std::memory_order_relaxed);
+            return true;
+        }
+
+        // remove the entry of the key if exists any
+        bool erase(const Key& key) {
+            const std::size_t hash = Hash{}(key);
+            Shard& shard = shard_of(hash);
+            std::scoped_lock lk(shard._m);
+            const std::size_t slot_index = find_slot(shard, hash, key);
+            if (slot_index == _SLOT_COUNT) return false;
+            retire(remove_slot(shard, slot_index));
+            return true;
+        }
+
+        // the approximate total weight of the entries
+        std::size_t size_in_bytes() const noexcept {
+            std::size_t bytes{};
+            for (std::size_t i = 0; i < _SHARD_COUNT; ++i)
+                bytes += _shards[i]._bytes.load(std::memory_order_relaxed);
+            return bytes;
+        }
+
+        inline std::size_t capacity_in_bytes() const noexcept {
+            return _shard_capacity * _SHARD_COUNT;
+        }
+
+    private:
+        const std::size_t _shard_capacity;
+        Weigher _weigher;
+        std::unique_ptr<Shard[]> _shards;
+    };
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_CACHE_HPP
@@ -0,0 +1,24 @@
+// Primary template for Concurrent_Deque.
+// Specialized by:
+//   - structure type
+//   - concurrency model
+//   - some additional case dependent arguments
+//     Ex: Enum_Structure_Types::Static_Array requires the capacity
+#ifndef CONCURRENT_DEQUE_HPP
+#define CONCURRENT_DEQUE_HPP
+
+#include <type_traits>
+#include "enum_structure_types.hpp"
+#include "enum_concurrency_models.hpp"
+
+namespace BA_Concurrency {
+    template <
+        bool Is_LF,
+        Enum_Structure_Types Structure_Type,
+        Enum_Concurrency_Models Concurrency_Model,
+        typename T,
+        typename... Args>
+    class Concurrent_Deque {};
+}
+
+#endif // CONCURRENT_DEQUE_HPP
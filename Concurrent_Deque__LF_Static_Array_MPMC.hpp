@@ -0,0 +1,325 @@
+// Concurrent_Deque__LF_Static_Array_MPMC.hpp
+//
+// CAUTION:
+//   I created this repository as a reference for my job applications.
+//   The code given in this repository is:
+//     - to introduce my experience with lock-free concurrency, atomic operations and the required C++ utilities,
+//     - to present my background with the concurrent data structures,
+//     - not to provide a tested production-ready multi-platform library.
+//
+// Description:
+//   The anchored-indices solution for the bounded lock-free/static array/MPMC deque problem:
+//     The left and right indices of the deque are packed into a single atomic word (the anchor).
+//     Each operation reserves its slot by a single CAS on the anchor
+//     and then works on the reserved slot without any contention with the other ends.
+//     Hence, no DCAS is required.
+//
+//   Schedulers can combine LIFO (locality) and FIFO (fairness)
+//   on the same deque instead of using a mutex protected std::deque:
+//     push_back + pop_back  : LIFO
+//     push_back + pop_front : FIFO
+//
+// Requirements:
+// - T must be noexcept-movable.
+//
+// Invariants:
+//   1. The anchor holds the two circular indices: {_left, _right}
+//      where the elements are in [_left, _right) and
+//      the size is (_right - _left) mod 2^32 which never exceeds _CAPACITY.
+//   2. The slot states follow the cycle:
+//        EMPTY -> WRITING -> FULL -> READING -> EMPTY
+//      Each transition out of EMPTY and FULL is a CAS by the owner of the reservation.
+//
+// Semantics:
+//   Slot class:
+//     The array is a contiguous array of Slot objects.
+//     A slot encapsulates two members:
+//       1. The data is stored in a byte array of size of T.
+//       2. The state of the slot: EMPTY, WRITING, FULL or READING.
+//
+//   push_back() / push_front():
+//     1. Load the anchor and return false if the deque is full
+//     2. CAS the anchor to extend the range by one slot at the corresponding end
+//        (the slot is reserved now)
+//     3. Wait until the slot is EMPTY and CAS it to WRITING
+//     4. Construct the data into the slot
+//     5. Publish the data: _state.store(FULL, std::memory_order_release)
+//   pop_back() / pop_front():
+//     1. Load the anchor and return std::nullopt if the deque is empty
+//     2. CAS the anchor to shrink the range by one slot at the corresponding end
+//        (the slot is reserved now)
+//     3. Wait until the slot is FULL and CAS it to READING
+//     4. Move the data out and destroy the slot object
+//     5. Release the slot: _state.store(EMPTY, std::memory_order_release)
+//     6. Return the data
+//
+// Progress:
+//   Similar to Concurrent_Queue__LF_Ring_MPMC.hpp:
+//     The anchor always advances (a failed CAS means another thread succeeded).
+//     However, a thread may spin on its reserved slot
+//     until the counterpart thread which reserved the same slot earlier
+//     finishes its write or read.
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//   2. The reservations for a slot alternate in the anchor order:
+//        push, pop, push, pop, ...
+//      Hence, every waiting thread is eventually served.
+//      The CAS on the slot state allows the overlapping reservations of the same slot
+//      to be served out of the reservation order.
+//      The element count is preserved but
+//      the order of the overlapping operations is preserved only logically
+//      (see the Progress section of Concurrent_Queue__LF_Ring_MPMC.hpp).
+//   3. All four operations serialize on the anchor.
+//      Use Concurrent_Queue__LF_Ring_MPMC.hpp
+//      if the deque is used only as a FIFO queue.
+//
+// Cautions:
+//   1. Threads may spin indefinitely if a counterpart thread fails mid-operation,
+//      before setting the slot state accordingly.
+//   2. Use deque_LF_static_array_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Deque
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider exponential backoff for the anchor CAS loop and the slot waits.
+
+#ifndef CONCURRENT_DEQUE_LF_STATIC_ARRAY_MPMC_HPP
+#define CONCURRENT_DEQUE_LF_STATIC_ARRAY_MPMC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "Concurrent_Deque.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    // use deque_LF_static_array_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Deque
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    requires (
+            Capacity_As_Pow2 < 32 &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Concurrent_Deque<
+        true,
+        Enum_Structure_Types::Static_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>>
+    {
+        static constexpr std::size_t _CAPACITY = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::size_t _MASK     = _CAPACITY - 1;
+
+        enum Slot_States : std::uint8_t { EMPTY, WRITING, FULL, READING };
+
+        // aligned to prevent false sharing
+        struct alignas(64) Slot {
+            std::atomic<std::uint8_t> _state{ EMPTY };
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        // the anchor packs the two circular indices into a single word
+        //   the lower half : _left  (the first element)
+        //   the upper half : _right (one past the last element)
+        static constexpr std::uint32_t left(std::uint64_t anchor) noexcept {
+            return static_cast<std::uint32_t>(anchor);
+        }
+        static constexpr std::uint32_t right(std::uint64_t anchor) noexcept {
+            return static_cast<std::uint32_t>(anchor >> 32);
+        }
+        static constexpr std::uint64_t make_anchor(std::uint32_t left, std::uint32_t right) noexcept {
+            return (static_cast<std::uint64_t>(right) << 32) | left;
+        }
+        static constexpr std::uint32_t anchor_size(std::uint64_t anchor) noexcept {
+            return right(anchor) - left(anchor);
+        }
+
+        // Steps 3-5 of the push functions
+        template <class U>
+        void write(Slot& slot, U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            std::uint8_t expected{ EMPTY };
+            while (
+                !slot._state.compare_exchange_weak(
+                    expected,
+                    WRITING,
+                    std::memory_order_acquire,
+                    std::memory_order_relaxed))
+                expected = EMPTY;
+            ::new (slot.to_ptr()) T(std::forward<U>(data));
+            slot._state.store(FULL, std::memory_order_release);
+        }
+
+        // Steps 3-6 of the pop functions
+        std::optional<T> read(Slot& slot) noexcept {
+            std::uint8_t expected{ FULL };
+            while (
+                !slot._state.compare_exchange_weak(
+                    expected,
+                    READING,
+                    std::memory_order_acquire,
+                    std::memory_order_relaxed))
+                expected = FULL;
+            T* ptr = slot.to_ptr();
+            std::optional<T> data{ std::move(*ptr) };
+            if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+            slot._state.store(EMPTY, std::memory_order_release);
+            return data;
+        }
+
+    public:
+
+        Concurrent_Deque() noexcept = default;
+
+        // Single-threaded context expected.
+        // destroy the elements that were pushed but not yet popped
+        ~Concurrent_Deque() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (auto& slot : _slots)
+                    if (slot._state.load(std::memory_order_relaxed) == FULL)
+                        slot.to_ptr()->~T();
+            }
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Deque(const Concurrent_Deque&) = delete;
+        Concurrent_Deque& operator=(const Concurrent_Deque&) = delete;
+        Concurrent_Deque(Concurrent_Deque&&) = delete;
+        Concurrent_Deque& operator=(Concurrent_Deque&&) = delete;
+
+        // Non-blocking push to the right end: Returns false if FULL at reservation time.
+        //   1. Load the anchor and return false if the deque is full
+        //   2. CAS the anchor: {left, right} -> {left, right + 1}
+        //   3. Wait until the slot at right is EMPTY and CAS it to WRITING
+        //   4. Construct the data into the slot
+        //   5. Publish the data: _state.store(FULL, std::memory_order_release)
+        template <class U>
+        bool push_back(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            // Step 1
+            std::uint64_t anchor = _anchor.value.load(std::memory_order_acquire);
+            do {
+                if (anchor_size(anchor) == _CAPACITY) return false;
+            } while( // Step 2
+                !_anchor.value.compare_exchange_weak(
+                    anchor,
+                    make_anchor(left(anchor), right(anchor) + 1),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire));
+
+            // Steps 3-5
+            write(_slots[right(anchor) & _MASK], std::forward<U>(data));
+            return true;
+        }
+
+        // Non-blocking push to the left end: Returns false if FULL at reservation time.
+        //   1. Load the anchor and return false if the deque is full
+        //   2. CAS the anchor: {left, right} -> {left - 1, right}
+        //   3. Wait until the slot at left - 1 is EMPTY and CAS it to WRITING
+        //   4. Construct the data into the slot
+        //   5. Publish the data: _state.store(FULL, std::memory_order_release)
+        template <class U>
+        bool push_front(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            // Step 1
+            std::uint64_t anchor = _anchor.value.load(std::memory_order_acquire);
+            do {
+                if (anchor_size(anchor) == _CAPACITY) return false;
+            } while( // Step 2
+                !_anchor.value.compare_exchange_weak(
+                    anchor,
+                    make_anchor(left(anchor) - 1, right(anchor)),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire));
+
+            // Steps 3-5
+            write(_slots[(left(anchor) - 1) & _MASK], std::forward<U>(data));
+            return true;
+        }
+
+        // Non-blocking pop from the right end: Returns nullopt if EMPTY at reservation time.
+        //   1. Load the anchor and return std::nullopt if the deque is empty
+        //   2. CAS the anchor: {left, right} -> {left, right - 1}
+        //   3. Wait until the slot at right - 1 is FULL and CAS it to READING
+        //   4. Move the data out and destroy the slot object
+        //   5. Release the slot: _state.store(EMPTY, std::memory_order_release)
+        //   6. Return the data
+        std::optional<T> pop_back() noexcept {
+            // Step 1
+            std::uint64_t anchor = _anchor.value.load(std::memory_order_acquire);
+            do {
+                if (anchor_size(anchor) == 0) return std::nullopt;
+            } while( // Step 2
+                !_anchor.value.compare_exchange_weak(
+                    anchor,
+                    make_anchor(left(anchor), right(anchor) - 1),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire));
+
+            // Steps 3-6
+            return read(_slots[(right(anchor) - 1) & _MASK]);
+        }
+
+        // Non-blocking pop from the left end: Returns nullopt if EMPTY at reservation time.
+        //   1. Load the anchor and return std::nullopt if the deque is empty
+        //   2. CAS the anchor: {left, right} -> {left + 1, right}
+        //   3. Wait until the slot at left is FULL and CAS it to READING
+        //   4. Move the data out and destroy the slot object
+        //   5. Release the slot: _state.store(EMPTY, std::memory_order_release)
+        //   6. Return the data
+        std::optional<T> pop_front() noexcept {
+            // Step 1
+            std::uint64_t anchor = _anchor.value.load(std::memory_order_acquire);
+            do {
+                if (anchor_size(anchor) == 0) return std::nullopt;
+            } while( // Step 2
+                !_anchor.value.compare_exchange_weak(
+                    anchor,
+                    make_anchor(left(anchor) + 1, right(anchor)),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire));
+
+            // Steps 3-6
+            return read(_slots[left(anchor) & _MASK]);
+        }
+
+        inline std::size_t size() const noexcept {
+            return anchor_size(_anchor.value.load(std::memory_order_acquire));
+        }
+
+        inline bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        inline std::size_t capacity() const noexcept { return _CAPACITY; }
+
+    private:
+
+        // MEMBERS:
+        // The anchor packing the left and right indices.
+        // The indices are circular (wraps at 2^32)
+        // and are mapped to the slots by the _MASK.
+        cache_line_wrapper<std::atomic<std::uint64_t>> _anchor{0};
+        Slot _slots[_CAPACITY];
+    };
+
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    using deque_LF_static_array_MPMC = Concurrent_Deque<
+        true,
+        Enum_Structure_Types::Static_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_DEQUE_LF_STATIC_ARRAY_MPMC_HPP
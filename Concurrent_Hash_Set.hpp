@@ -0,0 +1,385 @@
+// Concurrent_Hash_Set.hpp
+//
+// Description:
+//   A sharded lock-free hash set of integer keys
+//   for deduplicating the in-flight jobs (see Thread_Pool__Unique.hpp):
+//     1. insert_if_absent, erase and contains are lock-free
+//        (except the rare migration of a shard table, see Progress).
+//     2. Each shard is an open addressing table (linear probing) of key slots.
+//     3. A key slot is claimed once by a key and never reused for another key.
+//        The membership of the key is a separate state (PRESENT or ABSENT).
+//        Hence, a key cannot be inserted into two slots (no duplicates).
+//     4. A shard table filled with the claimed slots is migrated into a new table
+//        containing the present keys only (the erased keys are dropped).
+//
+// Requirements:
+// - Key must be an unsigned integer type.
+//   Hash the other keys (e.g. strings) into 64-bit keys.
+// - The maximum value of Key is reserved (the empty slot).
+//
+// Design:
+//   Slot:
+//     _key  : the claiming key (EMPTY if not claimed yet)
+//     _state: PRESENT or ABSENT together with the FROZEN bit set by the migration
+//   Table:
+//     _slots    : the key slots (pow2 capacity)
+//     _claimed  : the number of the claimed slots
+//     _migrating: the flag selecting the migrating thread
+//   Shard:
+//     _table: the current table (protected by the hazard ptrs)
+//     _size : the number of the present keys
+//
+//   The shard of a key is selected by the low bits of the hash
+//   and the home slot by the remaining bits.
+//
+// Semantics:
+//   insert_if_absent(key):
+//     1. Protect the shard table by a hazard ptr
+//     2. If the table exceeds the load factor (3/4 claimed), migrate the table and retry
+//     3. Probe the slots starting from the home slot:
+//          Claim the first empty slot by CAS or find the slot claimed by the key
+//     4. CAS the state of the slot from ABSENT to PRESENT
+//          If the slot is FROZEN, wait for the migration and retry in the new table
+//          Return false if the key is PRESENT already
+//   erase(key):
+//     1. Protect the shard table by a hazard ptr
+//     2. Probe the slots until the slot of the key or an empty slot
+//     3. CAS the state of the slot from PRESENT to ABSENT
+//          If the slot is FROZEN, wait for the migration and retry in the new table
+//   migration:
+//     1. The first thread setting the _migrating flag freezes all slots (fetch_or FROZEN)
+//        Hence, no state can change after the freeze.
+//     2. Copy the present keys into a new table (sized for the present keys)
+//     3. Publish the new table and retire the old table through the hazard ptrs
+//     The other threads wait until the new table is published.
+//
+// Progress:
+//   Lock-free:
+//     insert_if_absent, erase and contains outside a migration.
+//   Blocking:
+//     The writers of a shard wait for the migrating thread.
+//     The migration is amortized over the insertions of the new keys (load factor 3/4).
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release a table before publishing it and
+//      to acquire a table after observing it.
+//      The hazard ptr publication and the validating re-load are separated
+//      by a sequentially consistent fence (store-load ordering).
+//   2. The hash of Hash is finalized by the 64-bit mixer of MurmurHash3
+//      as std::hash of the integers is the identity
+//      which clusters the linear probing.
+//
+// Cautions:
+//   1. The retired tables are reclaimed per thread (see Hazard_Ptr.hpp).
+//   2. size is approximate under concurrent modification.
+//
+// TODOs:
+//   1. Consider the cooperative migration (the waiting writers copy the slots as well).
+
+#ifndef CONCURRENT_HASH_SET_HPP
+#define CONCURRENT_HASH_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <limits>
+#include <concepts>
+#include <functional>
+#include <algorithm>
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+#include "Hazard_Ptr.hpp"
+
+namespace BA_Concurrency {
+    template <
+        std::unsigned_integral Key = std::uint64_t,
+        typename Hash = std::hash<Key>,
+        unsigned char Shard_Count_As_Pow2 = 4,
+        unsigned char Slot_Count_As_Pow2 = 8,
+        std::size_t Hazard_Ptr_Record_Count = HAZARD_PTR_RECORD_COUNT__DEFAULT>
+    requires (Slot_Count_As_Pow2 >= 2)
+    class Concurrent_Hash_Set {
+        static constexpr std::size_t _SHARD_COUNT = pow2_size<Shard_Count_As_Pow2>;
+        static constexpr std::size_t _SHARD_MASK  = _SHARD_COUNT - 1;
+        static constexpr std::size_t _MIN_SLOT_COUNT = pow2_size<Slot_Count_As_Pow2>;
+        static constexpr Key _EMPTY = std::numeric_limits<Key>::max();
+
+        // the slot states
+        static constexpr std::uint32_t _ABSENT  = 0;
+        static constexpr std::uint32_t _PRESENT = 1;
+        static constexpr std::uint32_t _FROZEN  = 2;
+
+        // local aliases
+        using _HPO = Hazard_Ptr_Owner<Hazard_Ptr_Record_Count>;
+
+        struct Slot {
+            std::atomic<Key> _key{ _EMPTY };
+            std::atomic<std::uint32_t> _state{ _ABSENT };
+        };
+
+        struct Table {
+            const std::size_t _slot_mask;
+            const std::unique_ptr<Slot[]> _slots;
+            std::atomic<std::size_t> _claimed{ 0 };
+            std::atomic<bool> _migrating{ false };
+
+            explicit Table(std::size_t slot_count)
+                : _slot_mask(slot_count - 1),
+                  _slots(std::make_unique<Slot[]>(slot_count)) {}
+
+            std::size_t max_claimed() const noexcept {
+                return (_slot_mask + 1) / 4 * 3;
+            }
+        };
+
+        struct Shard {
+            std::atomic<Table*> _table{ nullptr };
+            std::atomic<std::size_t> _size{ 0 };
+        };
+
+        // deleter to be supplied to Hazard_Ptr_Owner for deferred reclamation
+        static void delete_table(void *ptr, void *) {
+            delete static_cast<Table*>(ptr);
+        }
+
+        // the 64-bit finalizer of MurmurHash3
+        static std::uint64_t hash_of(Key key) noexcept {
+            std::uint64_t hash = static_cast<std::uint64_t>(Hash{}(key));
+            hash ^= hash >> 33;
+            hash *= 0xff51afd7ed558ccdull;
+            hash ^= hash >> 33;
+            hash *= 0xc4ceb9fe1a85ec53ull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        static std::size_t home_slot(std::uint64_t hash, const Table* table) noexcept {
+            return static_cast<std::size_t>(hash >> Shard_Count_As_Pow2) & table->_slot_mask;
+        }
+
+        Shard& shard_of(std::uint64_t hash) const noexcept {
+            return _shards[hash & _SHARD_MASK].value;
+        }
+
+        // Step 1: protect the shard table by a hazard ptr and validate the shard
+        static Table* protect_table(const Shard& shard, const _HPO& hazard_ptr_owner) noexcept {
+            Table* table = shard._table.load(std::memory_order_acquire);
+            while (true) {
+                hazard_ptr_owner.protect(table);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                Table* validated = shard._table.load(std::memory_order_acquire);
+                if (validated == table) return table;
+                table = validated;
+            }
+        }
+
+        // migrate the table or wait for the migrating thread
+        void migrate(Shard& shard, Table* table) {
+            if (table->_migrating.exchange(true, std::memory_order_acq_rel)) {
+                while (shard._table.load(std::memory_order_acquire) == table)
+                    std::this_thread::yield();
+                return;
+            }
+
+            // Step 1: freeze
+            std::size_t present_count{};
+            for (std::size_t i = 0; i <= table->_slot_mask; ++i)
+                if (
+                    (table->_slots[i]._state.fetch_or(_FROZEN, std::memory_order_acq_rel) & ~_FROZEN) ==
+                    _PRESENT)
+                    ++present_count;
+
+            // Step 2: copy the present keys
+            std::size_t slot_count = _MIN_SLOT_COUNT;
+            while (slot_count < present_count * 4) slot_count <<= 1;
+            Table* new_table = new Table(slot_count);
+            for (std::size_t i = 0; i <= table->_slot_mask; ++i) {
+                const Slot& slot = table->_slots[i];
+                if ((slot._state.load(std::memory_order_relaxed) & ~_FROZEN) != _PRESENT) continue;
+                const Key key = slot._key.load(std::memory_order_relaxed);
+                std::size_t slot_index = home_slot(hash_of(key), new_table);
+                while (new_table->_slots[slot_index]._key.load(std::memory_order_relaxed) != _EMPTY)
+                    slot_index = (slot_index + 1) & new_table->_slot_mask;
+                new_table->_slots[slot_index]._key.store(key, std::memory_order_relaxed);
+                new_table->_slots[slot_index]._state.store(_PRESENT, std::memory_order_relaxed);
+            }
+            new_table->_claimed.store(present_count, std::memory_order_relaxed);
+
+            // Step 3: publish and retire
+            shard._table.store(new_table, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // the table update before the hazard ptr scan
+            _HPO::reclaim_memory_later(static_cast<void*>(table), nullptr, &delete_table);
+        }
+
+    public:
+
+        Concurrent_Hash_Set() {
+            for (std::size_t i = 0; i < _SHARD_COUNT; ++i)
+                _shards[i].value._table.store(new Table(_MIN_SLOT_COUNT), std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        ~Concurrent_Hash_Set() {
+            for (std::size_t i = 0; i < _SHARD_COUNT; ++i)
+                delete _shards[i].value._table.load(std::memory_order_relaxed);
+
+            // TODO:
+            //   Defered reclamation is per thread base (see Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp).
+            _HPO::try_reclaim_memory();
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Hash_Set(const Concurrent_Hash_Set&) = delete;
+        Concurrent_Hash_Set& operator=(const Concurrent_Hash_Set&) = delete;
+        Concurrent_Hash_Set(Concurrent_Hash_Set&&) = delete;
+        Concurrent_Hash_Set& operator=(Concurrent_Hash_Set&&) = delete;
+
+        // returns false if the key is present already.
+        //   1. Protect the shard table by a hazard ptr
+        //   2. Migrate the table if it exceeds the load factor
+        //   3. Claim an empty slot or find the slot of the key
+        //   4. CAS the state from ABSENT to PRESENT
+        bool insert_if_absent(Key key) {
+            const std::uint64_t hash = hash_of(key);
+            Shard& shard = shard_of(hash);
+            _HPO hazard_ptr_owner;
+
+            while (true) {
+                // Step 1
+                Table* table = protect_table(shard, hazard_ptr_owner);
+
+                // Step 2
+                if (table->_claimed.load(std::memory_order_relaxed) >= table->max_claimed()) {
+                    migrate(shard, table);
+                    continue;
+                }
+
+                // Step 3
+                Slot* slot{};
+                std::size_t slot_index = home_slot(hash, table);
+                for (std::size_t probe = 0; probe <= table->_slot_mask; ++probe) {
+                    Slot& candidate = table->_slots[slot_index];
+                    Key slot_key = candidate._key.load(std::memory_order_acquire);
+                    if (
+                        slot_key == _EMPTY &&
+                        candidate._key.compare_exchange_strong(
+                            slot_key,
+                            key,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        table->_claimed.fetch_add(1, std::memory_order_relaxed);
+                        slot_key = key;
+                    }
+                    if (slot_key == key) {
+                        slot = &candidate;
+                        break;
+                    }
+                    slot_index = (slot_index + 1) & table->_slot_mask;
+                }
+                if (!slot) {
+                    migrate(shard, table);
+                    continue;
+                }
+
+                // Step 4
+                std::uint32_t state = slot->_state.load(std::memory_order_acquire);
+                while (state == _ABSENT)
+                    if (
+                        slot->_state.compare_exchange_weak(
+                            state,
+                            _PRESENT,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        shard._size.fetch_add(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                if (state == _PRESENT) return false;
+                migrate(shard, table); // frozen
+            }
+        }
+
+        // returns false if the key is absent.
+        //   1. Protect the shard table by a hazard ptr
+        //   2. Probe the slots until the slot of the key or an empty slot
+        //   3. CAS the state from PRESENT to ABSENT
+        bool erase(Key key) {
+            const std::uint64_t hash = hash_of(key);
+            Shard& shard = shard_of(hash);
+            _HPO hazard_ptr_owner;
+
+            while (true) {
+                // Step 1
+                Table* table = protect_table(shard, hazard_ptr_owner);
+
+                // Step 2
+                Slot* slot{};
+                std::size_t slot_index = home_slot(hash, table);
+                for (std::size_t probe = 0; probe <= table->_slot_mask; ++probe) {
+                    Slot& candidate = table->_slots[slot_index];
+                    const Key slot_key = candidate._key.load(std::memory_order_acquire);
+                    if (slot_key == _EMPTY) return false;
+                    if (slot_key == key) {
+                        slot = &candidate;
+                        break;
+                    }
+                    slot_index = (slot_index + 1) & table->_slot_mask;
+                }
+                if (!slot) return false;
+
+                // Step 3
+                std::uint32_t state = slot->_state.load(std::memory_order_acquire);
+                while (state == _PRESENT)
+                    if (
+                        slot->_state.compare_exchange_weak(
+                            state,
+                            _ABSENT,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        shard._size.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                if (state == _ABSENT) return false;
+                migrate(shard, table); // frozen
+            }
+        }
+
+        bool contains(Key key) const {
+            const std::uint64_t hash = hash_of(key);
+            const Shard& shard = shard_of(hash);
+            _HPO hazard_ptr_owner;
+            const Table* table = protect_table(shard, hazard_ptr_owner);
+
+            std::size_t slot_index = home_slot(hash, table);
+            for (std::size_t probe = 0; probe <= table->_slot_mask; ++probe) {
+                const Slot& slot = table->_slots[slot_index];
+                const Key slot_key = slot._key.load(std::memory_order_acquire);
+                if (slot_key == _EMPTY) return false;
+                if (slot_key == key)
+                    return (slot._state.load(std::memory_order_acquire) & ~_FROZEN) == _PRESENT;
+                slot_index = (slot_index + 1) & table->_slot_mask;
+            }
+            return false;
+        }
+
+        // approximate under concurrent modification
+        std::size_t size() const noexcept {
+            std::size_t count{};
+            for (std::size_t i = 0; i < _SHARD_COUNT; ++i)
+                count += _shards[i].value._size.load(std::memory_order_relaxed);
+            return count;
+        }
+
+    private:
+
+        // MEMBERS:
+        mutable cache_line_wrapper<Shard> _shards[_SHARD_COUNT];
+    };
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_HASH_SET_HPP
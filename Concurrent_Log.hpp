@@ -0,0 +1,331 @@
+// Concurrent_Log.hpp
+//
+// Description:
+//   The lock-free single-writer multi-reader append-only log (an in-memory event journal):
+//     A single writer appends the records
+//     while any number of readers follow the tail with their own cursors.
+//     The readers never block the writer and may join late.
+//     A building block for the replication and the replay.
+//
+// Requirements:
+// - T must be copy constructible (the readers copy the records out).
+//
+// Design:
+//   Segment:
+//     A chunk of Segment_Size records linked atomically to the next segment:
+//       _base_offset: the log offset of the first record of the segment
+//       _committed  : the number of the committed (i.e. readable) records of the segment
+//       _next       : the next segment
+//       _records    : the raw storage of the records
+//   Log:
+//     _head            : the oldest retained segment
+//     _head_base_offset: the base offset of the oldest retained segment
+//     _tail            : the segment being appended (published for the late joiners)
+//     _committed_offset: the offset of the next record to be appended (waited by wait_for)
+//   Cursor:
+//     A reader position: {segment, offset}
+//     protecting its current segment by an exclusive hazard ptr record
+//     (not shared with the other hazard ptr owners of the thread, see Hazard_Ptr.hpp Semantics 7).
+//     Hence, the reader may use the other hazard ptr structures (and more cursors) between the reads.
+//
+// Semantics:
+//   append(data) (writer only):
+//     1. If the tail segment is full, link a new segment and publish it as the tail
+//     2. Construct the record into the next index of the tail segment
+//     3. Publish the record: segment._committed.store(index + 1, std::memory_order_release)
+//     4. Publish the committed offset and notify the waiting readers
+//   truncate_before(offset) (writer only):
+//     1. Advance the head while the head segment ends before the offset (the tail is retained)
+//     2. Publish the new head base offset
+//     3. Retire the detached segments via the hazard ptrs
+//   Cursor::try_read():
+//     1. If the cursor reached the end of its segment, move to the next segment:
+//          Protect the next segment by the hazard ptr and validate that it is not truncated yet
+//          If truncated, the cursor falls behind and jumps to the head
+//     2. Return std::nullopt if the record at the cursor is not committed yet
+//     3. Copy the record and advance the cursor
+//   wait_for(offset):
+//     Block until the record at the offset is committed (std::atomic::wait).
+//
+// Progress:
+//   append  : wait-free (except the segment allocation)
+//   try_read: lock-free
+//   wait_for: blocking
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release the records before the visibility of the committed counters and
+//      to acquire the records after observing the committed counters.
+//      The hazard ptr publication and the validating re-load are separated
+//      by a sequentially consistent fence (store-load ordering).
+//   2. The records are immutable after the commit.
+//      Hence, the readers do not interfere with each other or with the writer.
+//
+// Cautions:
+//   1. append and truncate_before must be called by the single writer thread.
+//   2. A cursor holds a hazard ptr record for its lifetime.
+//      Hence, the live cursors (and the threads using the hazard ptrs) are bounded
+//      by Hazard_Ptr_Record_Count (exceeding it terminates).
+//   3. A reader lagging behind truncate_before skips the truncated records:
+//      the offset of the cursor jumps to the head.
+//
+// TODOs:
+//   1. Consider recycling the retired segments instead of deallocating them.
+
+#ifndef CONCURRENT_LOG_HPP
+#define CONCURRENT_LOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+#include "Hazard_Ptr.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename T,
+        unsigned char Segment_Size_As_Pow2 = 10,
+        std::size_t Hazard_Ptr_Record_Count = HAZARD_PTR_RECORD_COUNT__DEFAULT>
+    requires std::is_copy_constructible_v<T>
+    class Concurrent_Log {
+        static constexpr std::size_t _SEGMENT_SIZE = pow2_size<Segment_Size_As_Pow2>;
+
+        // local aliases
+        using _HPO = Hazard_Ptr_Owner<Hazard_Ptr_Record_Count>;
+
+        struct Segment {
+            const std::size_t _base_offset;
+            std::atomic<std::size_t> _committed{ 0 };
+            std::atomic<Segment*> _next{ nullptr };
+            alignas(T) unsigned char _records[_SEGMENT_SIZE * sizeof(T)];
+
+            explicit Segment(std::size_t base_offset) noexcept : _base_offset(base_offset) {}
+            ~Segment() {
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    const std::size_t committed = _committed.load(std::memory_order_relaxed);
+                    for (std::size_t i = 0; i < committed; ++i) to_ptr(i)->~T();
+                }
+            }
+            T* to_ptr(std::size_t index) noexcept {
+                return std::launder(reinterpret_cast<T*>(_records) + index);
+            }
+        };
+
+        // deleter to be supplied to Hazard_Ptr_Owner for deferred reclamation
+        static void delete_segment(void *ptr, void *) {
+            delete static_cast<Segment*>(ptr);
+        }
+
+    public:
+
+        // A reader position protecting its current segment by a hazard ptr.
+        // See Caution 2 in the header documentation.
+        class Cursor {
+            friend class Concurrent_Log;
+
+            const Concurrent_Log* _log;
+            _HPO _hazard_ptr_owner{ Hazard_Ptr_Exclusive{} };
+            Segment* _segment{};
+            std::size_t _offset{};
+
+            // protect the segment loaded from the source and validate
+            Segment* protect(const std::atomic<Segment*>& source) {
+                Segment* segment = source.load(std::memory_order_acquire);
+                Segment* temp;
+                do {
+                    temp = segment;
+                    _hazard_ptr_owner.protect(segment);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    segment = source.load(std::memory_order_acquire);
+                } while (segment != temp);
+                return segment;
+            }
+
+            // jump to the oldest retained segment
+            void jump_to_head() {
+                _segment = protect(_log->_head.value);
+                _offset = _segment->_base_offset;
+            }
+
+            Cursor(const Concurrent_Log* log, bool at_tail) : _log(log) {
+                if (at_tail) {
+                    _segment = protect(_log->_tail.value);
+                    _offset =
+                        _segment->_base_offset +
+                        _segment->_committed.load(std::memory_order_acquire);
+                }
+                else jump_to_head();
+            }
+
+        public:
+
+            Cursor(Cursor&&) noexcept = default;
+            Cursor& operator=(Cursor&&) noexcept = default;
+
+            // the offset of the next record to be read
+            std::size_t offset() const noexcept { return _offset; }
+
+            // non-blocking read: Returns nullopt if the next record is not committed yet.
+            //   1. If the cursor reached the end of its segment, move to the next segment
+            //   2. Return std::nullopt if the record at the cursor is not committed yet
+            //   3. Copy the record and advance the cursor
+            std::optional<T> try_read() {
+                // Step 1
+                if (_offset == _segment->_base_offset + _SEGMENT_SIZE) {
+                    Segment* next = _segment->_next.load(std::memory_order_acquire);
+                    if (!next) return std::nullopt;
+                    _hazard_ptr_owner.protect(next);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                    // the next segment is alive if it is not truncated yet
+                    if (_log->_head_base_offset.load(std::memory_order_acquire) <= _offset)
+                        _segment = next;
+                    else
+                        jump_to_head(); // the cursor fell behind the truncation
+                }
+
+                // Step 2
+                const std::size_t index = _offset - _segment->_base_offset;
+                if (index >= _segment->_committed.load(std::memory_order_acquire))
+                    return std::nullopt;
+
+                // Step 3
+                std::optional<T> data{ *_segment->to_ptr(index) };
+                ++_offset;
+                return data;
+            }
+
+            // blocking read: waits until the next record is committed
+            T read() {
+                while (true) {
+                    if (auto data = try_read(); data.has_value())
+                        return *std::move(data);
+                    _log->wait_for(_offset);
+                }
+            }
+        };
+
+        Concurrent_Log() {
+            auto* segment = new Segment(0);
+            _head.value.store(segment, std::memory_order_relaxed);
+            _tail.value.store(segment, std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        ~Concurrent_Log() {
+            Segment* segment = _head.value.load(std::memory_order_relaxed);
+            while (segment) {
+                Segment* next = segment->_next.load(std::memory_order_relaxed);
+                delete segment;
+                segment = next;
+            }
+
+            // TODO:
+            //   Defered reclamation is per thread base (see Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp).
+            _HPO::try_reclaim_memory();
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Log(const Concurrent_Log&) = delete;
+        Concurrent_Log& operator=(const Concurrent_Log&) = delete;
+        Concurrent_Log(Concurrent_Log&&) = delete;
+        Concurrent_Log& operator=(Concurrent_Log&&) = delete;
+
+        // append a record (writer only) and return its offset
+        //   1. If the tail segment is full, link a new segment and publish it as the tail
+        //   2. Construct the record into the next index of the tail segment
+        //   3. Publish the record
+        //   4. Publish the committed offset and notify the waiting readers
+        template <typename U = T>
+        std::size_t append(U&& data) {
+            Segment* tail = _tail.value.load(std::memory_order_relaxed);
+            std::size_t index = tail->_committed.load(std::memory_order_relaxed);
+
+            // Step 1
+            if (index == _SEGMENT_SIZE) {
+                auto* segment = new Segment(tail->_base_offset + _SEGMENT_SIZE);
+                tail->_next.store(segment, std::memory_order_release);
+                _tail.value.store(segment, std::memory_order_release);
+                tail = segment;
+                index = 0;
+            }
+
+            // Step 2
+            ::new (tail->to_ptr(index)) T(std::forward<U>(data));
+
+            // Step 3
+            tail->_committed.store(index + 1, std::memory_order_release);
+
+            // Step 4
+            const std::size_t offset = tail->_base_offset + index;
+            _committed_offset.value.store(offset + 1, std::memory_order_release);
+            _committed_offset.value.notify_all();
+            return offset;
+        }
+
+        // retire the segments which end before the offset (writer only)
+        //   1. Advance the head while the head segment ends before the offset
+        //   2. Publish the new head base offset
+        //   3. Retire the detached segments via the hazard ptrs
+        void truncate_before(std::size_t offset) {
+            Segment* old_head = _head.value.load(std::memory_order_relaxed);
+            Segment* head = old_head;
+
+            // Step 1
+            while (
+                head != _tail.value.load(std::memory_order_relaxed) &&
+                head->_base_offset + _SEGMENT_SIZE <= offset)
+                head = head->_next.load(std::memory_order_relaxed);
+            if (head == old_head) return;
+            _head.value.store(head, std::memory_order_release);
+
+            // Step 2
+            _head_base_offset.store(head->_base_offset, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_seq_cst); // the head update before the hazard ptr scan
+
+            // Step 3
+            while (old_head != head) {
+                Segment* next = old_head->_next.load(std::memory_order_relaxed);
+                _HPO::reclaim_memory_later(static_cast<void*>(old_head), nullptr, &delete_segment);
+                old_head = next;
+            }
+        }
+
+        // a cursor starting from the oldest retained record
+        Cursor cursor_at_head() const { return Cursor(this, false); }
+
+        // a cursor starting from the next record to be appended (a late joiner)
+        Cursor cursor_at_tail() const { return Cursor(this, true); }
+
+        // block until the record at the offset is committed
+        void wait_for(std::size_t offset) const {
+            std::size_t committed_offset = _committed_offset.value.load(std::memory_order_acquire);
+            while (committed_offset <= offset) {
+                _committed_offset.value.wait(committed_offset, std::memory_order_acquire);
+                committed_offset = _committed_offset.value.load(std::memory_order_acquire);
+            }
+        }
+
+        // the offset of the next record to be appended
+        std::size_t committed_offset() const noexcept {
+            return _committed_offset.value.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        // MEMBERS:
+        // The head and the tail are accessed by the readers joining
+        // and are separated from the committed offset polled by the readers.
+        cache_line_wrapper<std::atomic<Segment*>> _head{ nullptr };
+        cache_line_wrapper<std::atomic<Segment*>> _tail{ nullptr };
+        cache_line_wrapper<std::atomic<std::size_t>> _committed_offset{ 0 };
+        std::atomic<std::size_t> _head_base_offset{ 0 };
+    };
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_LOG_HPP
@@ -0,0 +1,309 @@
+// Concurrent_Priority_Queue.hpp
+//
+// Description:
+//   A relaxed concurrent MPMC priority queue (the MultiQueue of Rihani, Sanders and Dementiev)
+//   for the graph workloads (SSSP, A*) which tolerate the out-of-order pops:
+//     1. The queue is composed of c*P sequential binary heaps
+//        where P is the number of the threads and c is the heap factor.
+//     2. Each heap is protected by a try-lock.
+//        A thread never waits for a heap lock but selects another heap.
+//     3. push inserts into a random heap.
+//     4. pop selects two random heaps and pops from the one with the better top.
+//     5. A thread sticks to the selected heaps for a number of operations
+//        for the cache locality (the stickiness period).
+//   The contention on a single heap lock is spread over c*P heaps
+//   while the two-choice selection bounds the rank error of the pops.
+//
+// Requirements:
+// - Priority must be trivially copyable and always lock-free as an atomic (e.g. integers, double).
+// - T must be noexcept-movable.
+//
+// Design:
+//   Heap:
+//     _lock : the try-lock
+//     _items: the binary heap of {priority, data} pairs (the best priority at the front)
+//     _top  : the priority of the front item (readable without the lock)
+//     _size : the number of the items     (readable without the lock)
+//   The selection of a heap reads _top and _size without the lock
+//   and re-checks the heap after acquiring the lock.
+//
+//   The per-thread state:
+//     _rng         : xorshift random number generator
+//     _push_index  : the sticky heap index of push
+//     _pop_indices : the sticky heap indices of pop
+//     _push_budget and _pop_budget: the remaining operations of the stickiness period
+//
+// Semantics:
+//   push(priority, data):
+//     1. Select the sticky heap (select a random heap if the stickiness period ends)
+//     2. Try-lock the heap. On failure, select a random heap and retry Step 2
+//     3. Push the item, update _top and _size and unlock
+//   try_pop():
+//     1. Select the two sticky heaps (select random heaps if the stickiness period ends)
+//     2. Compare the tops of the two heaps and select the better non-empty one
+//     3. Try-lock the heap. On failure or if the heap is empty, select random heaps and retry Step 2
+//     4. Pop the front item, update _top and _size and unlock
+//     5. If the random selections keep hitting the empty heaps,
+//        scan all heaps for an item and return std::nullopt only if all heaps are empty
+//
+// Progress:
+//   Blocking:
+//     The heaps are protected by the locks.
+//     However, a thread never waits for a lock held by another thread
+//     except during the final scan of try_pop.
+//
+// Notes:
+//   1. The pops are relaxed:
+//      The popped item is not necessarily the best item of the queue.
+//      The expected rank error is O(c*P) (see the MultiQueue paper).
+//   2. The sticky heap indices are shared by all queues of the same type in a thread
+//      (the indices are reduced modulo the heap count of the queue).
+//
+// Cautions:
+//   1. size and empty are approximate under concurrent modification.
+//   2. try_pop may return std::nullopt while a concurrent push is in progress.
+//
+// TODOs:
+//   1. Consider buffered insertions and deletions (the insertion and deletion buffers of the MultiQueue).
+
+#ifndef CONCURRENT_PRIORITY_QUEUE_HPP
+#define CONCURRENT_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename Priority,
+        typename T,
+        typename Compare = std::less<Priority>,
+        std::size_t Stickiness = 8>
+    requires (
+            std::is_trivially_copyable_v<Priority> &&
+            std::atomic<Priority>::is_always_lock_free &&
+            std::is_nothrow_move_constructible_v<T> &&
+            Stickiness > 0)
+    class Concurrent_Priority_Queue {
+        static constexpr std::size_t _POP_RETRY_COUNT = 16;
+
+        // the test-and-test-and-set lock satisfying Lockable
+        struct Spin_Lock {
+            std::atomic<bool> _locked{ false };
+
+            bool try_lock() noexcept {
+                return
+                    !_locked.load(std::memory_order_relaxed) &&
+                    !_locked.exchange(true, std::memory_order_acquire);
+            }
+            void lock() noexcept {
+                while (!try_lock()) std::this_thread::yield();
+            }
+            void unlock() noexcept {
+                _locked.store(false, std::memory_order_release);
+            }
+        };
+
+        using _Item = std::pair<Priority, T>;
+
+        struct Heap {
+            Spin_Lock _lock;
+            std::vector<_Item> _items;
+            std::atomic<Priority> _top{};
+            std::atomic<std::size_t> _size{ 0 };
+        };
+
+        struct Thread_State {
+            std::uint64_t _rng;
+            std::size_t _push_index{};
+            std::size_t _pop_indices[2]{};
+            std::size_t _push_budget{};
+            std::size_t _pop_budget{};
+
+            Thread_State() noexcept {
+                static std::atomic<std::uint64_t> seed{ 0x9E3779B97F4A7C15ull };
+                _rng = seed.fetch_add(0x9E3779B97F4A7C15ull, std::memory_order_relaxed) | 1;
+            }
+
+            // xorshift64
+            std::size_t next(std::size_t bound) noexcept {
+                _rng ^= _rng << 13;
+                _rng ^= _rng >> 7;
+                _rng ^= _rng << 17;
+                return static_cast<std::size_t>(_rng % bound);
+            }
+        };
+
+        static Thread_State& thread_state() noexcept {
+            static thread_local Thread_State state;
+            return state;
+        }
+
+        // the heap order: the best priority at the front
+        struct Item_Compare {
+            Compare _compare;
+            bool operator()(const _Item& lhs, const _Item& rhs) const {
+                return _compare(rhs.first, lhs.first);
+            }
+        };
+
+        // refresh _top and _size (the lock is held)
+        static void publish(Heap& heap) noexcept {
+            if (!heap._items.empty())
+                heap._top.store(heap._items.front().first, std::memory_order_relaxed);
+            heap._size.store(heap._items.size(), std::memory_order_release);
+        }
+
+        // pop the front item (the lock is held and the heap is not empty)
+        _Item pop_front(Heap& heap) {
+            std::pop_heap(heap._items.begin(), heap._items.end(), Item_Compare{ _compare });
+            _Item item{ std::move(heap._items.back()) };
+            heap._items.pop_back();
+            publish(heap);
+            return item;
+        }
+
+        // Step 2 of try_pop: select the better non-empty heap of the two (nullptr if both are empty)
+        Heap* select_better(std::size_t index_1, std::size_t index_2) noexcept {
+            Heap& heap_1 = _heaps[index_1].value;
+            Heap& heap_2 = _heaps[index_2].value;
+            const bool empty_1 = heap_1._size.load(std::memory_order_acquire) == 0;
+            const bool empty_2 = heap_2._size.load(std::memory_order_acquire) == 0;
+            if (empty_1) return empty_2 ? nullptr : &heap_2;
+            if (empty_2) return &heap_1;
+            return
+                _compare(
+                    heap_2._top.load(std::memory_order_relaxed),
+                    heap_1._top.load(std::memory_order_relaxed))
+                        ? &heap_2
+                        : &heap_1;
+        }
+
+    public:
+
+        // the heap count is heap_factor * thread_count
+        explicit Concurrent_Priority_Queue(
+            std::size_t thread_count = std::thread::hardware_concurrency(),
+            std::size_t heap_factor = 2,
+            Compare compare = Compare{})
+                : _heap_count(std::max<std::size_t>(2, heap_factor * std::max<std::size_t>(1, thread_count))),
+                  _heaps(std::make_unique<cache_line_wrapper<Heap>[]>(_heap_count)),
+                  _compare(std::move(compare)) {}
+
+        // Single-threaded context expected.
+        ~Concurrent_Priority_Queue() = default;
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Priority_Queue(const Concurrent_Priority_Queue&) = delete;
+        Concurrent_Priority_Queue& operator=(const Concurrent_Priority_Queue&) = delete;
+        Concurrent_Priority_Queue(Concurrent_Priority_Queue&&) = delete;
+        Concurrent_Priority_Queue& operator=(Concurrent_Priority_Queue&&) = delete;
+
+        template <typename U>
+        void push(Priority priority, U&& data) {
+            Thread_State& state = thread_state();
+
+            // Step 1
+            if (state._push_budget == 0) {
+                state._push_index = state.next(_heap_count);
+                state._push_budget = Stickiness;
+            }
+            --state._push_budget;
+
+            // Step 2
+            std::size_t index = state._push_index % _heap_count;
+            std::unique_lock lock(_heaps[index].value._lock, std::try_to_lock);
+            while (!lock.owns_lock()) {
+                index = state.next(_heap_count);
+                lock = std::unique_lock(_heaps[index].value._lock, std::try_to_lock);
+            }
+            state._push_index = index;
+
+            // Step 3
+            Heap& heap = _heaps[index].value;
+            heap._items.emplace_back(priority, std::forward<U>(data));
+            std::push_heap(heap._items.begin(), heap._items.end(), Item_Compare{ _compare });
+            publish(heap);
+        }
+
+        // returns the {priority, data} pair of a near-best item
+        std::optional<std::pair<Priority, T>> try_pop() {
+            Thread_State& state = thread_state();
+
+            // Step 1
+            if (state._pop_budget == 0) {
+                state._pop_indices[0] = state.next(_heap_count);
+                state._pop_indices[1] = state.next(_heap_count);
+                state._pop_budget = Stickiness;
+            }
+            --state._pop_budget;
+
+            for (std::size_t retry = 0; retry < _POP_RETRY_COUNT; ++retry) {
+                // Step 2
+                Heap* heap = select_better(
+                    state._pop_indices[0] % _heap_count,
+                    state._pop_indices[1] % _heap_count);
+
+                // Step 3
+                if (heap) {
+                    std::unique_lock lock(heap->_lock, std::try_to_lock);
+                    if (lock.owns_lock() && !heap->_items.empty()) {
+                        // Step 4
+                        return pop_front(*heap);
+                    }
+                }
+                state._pop_indices[0] = state.next(_heap_count);
+                state._pop_indices[1] = state.next(_heap_count);
+                state._pop_budget = Stickiness;
+            }
+
+            // Step 5
+            for (std::size_t i = 0; i < _heap_count; ++i) {
+                Heap& heap = _heaps[i].value;
+                if (heap._size.load(std::memory_order_acquire) == 0) continue;
+                std::scoped_lock lock(heap._lock);
+                if (!heap._items.empty()) return pop_front(heap);
+            }
+            return std::nullopt;
+        }
+
+        // approximate under concurrent modification
+        std::size_t size() const noexcept {
+            std::size_t count{};
+            for (std::size_t i = 0; i < _heap_count; ++i)
+                count += _heaps[i].value._size.load(std::memory_order_acquire);
+            return count;
+        }
+
+        // approximate under concurrent modification
+        bool empty() const noexcept {
+            for (std::size_t i = 0; i < _heap_count; ++i)
+                if (_heaps[i].value._size.load(std::memory_order_acquire)) return false;
+            return true;
+        }
+
+        std::size_t heap_count() const noexcept {
+            return _heap_count;
+        }
+
+    private:
+
+        // MEMBERS:
+        // The heaps are cache line aligned to avoid the false sharing of the locks.
+        const std::size_t _heap_count;
+        std::unique_ptr<cache_line_wrapper<Heap>[]> _heaps;
+        [[no_unique_address]] Compare _compare;
+    };
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_PRIORITY_QUEUE_HPP
@@ -0,0 +1,280 @@
+// Concurrent_Queue__Blocking_CoDel.hpp
+//
+// Description:
+//   The blocking MPMC queue (see Concurrent_Queue__Blocking.hpp)
+//   with an optional active queue management (AQM) following CoDel (RFC 8289):
+//     1. push timestamps the items.
+//     2. pop tracks the sojourn time (the time spent in the queue) of the front item.
+//     3. When the sojourn time stays above the target for an interval (a standing queue),
+//        the queue enters the dropping state and drops the oldest items
+//        at the increasing rate of the control law (interval / sqrt(count)).
+//     4. The dropped items are passed to the drop callback (e.g. to reject the requests).
+//     5. Optionally (adaptive LIFO), the items are served newest-first in the dropping state
+//        so that the fresh items meet their deadlines while the stale items are dropped from the front.
+//   Hence, the latency stays bounded under overload instead of degrading for all items.
+//
+// Requirements:
+// - T must be movable.
+// - The drop callback must not throw.
+//
+// Semantics:
+//   pop (and try_pop):
+//     1. Wait until an item is available (or the queue is closed)
+//     2. Evaluate the sojourn time of the front item:
+//          below the target (or a single item): reset the above-target timer
+//          above the target for an interval   : ok to drop
+//     3. dropping state:
+//          leave the state if not ok to drop
+//          otherwise, drop the front items while the drop time is reached
+//          (the next drop time follows the control law)
+//        not dropping state:
+//          if ok to drop, drop the front item and enter the dropping state
+//     4. Pop the front item (the back item in the dropping state if adaptive LIFO is enabled)
+//     5. Invoke the drop callback on the dropped items out of the lock
+//   close:
+//     Wakes the waiting consumers. pop returns std::nullopt when the queue is closed and empty.
+//
+// Progress:
+//   Blocking
+//
+// Notes:
+//   1. The default configuration disables AQM (the target is infinite)
+//      and the queue behaves as Concurrent_Queue__Blocking (no timestamps are read).
+//   2. The count of the dropping state is carried over a short non-dropping period
+//      (RFC 8289, Section 5.5).
+//
+// Cautions:
+//   1. The sojourn times are measured by std::chrono::steady_clock.
+//
+// TODOs:
+//   1. Consider the bytes-based standing queue detection (the MTU check of RFC 8289).
+
+#ifndef CONCURRENT_QUEUE_BLOCKING_CODEL_HPP
+#define CONCURRENT_QUEUE_BLOCKING_CODEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <condition_variable>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "enum_structure_types.hpp"
+#include "enum_concurrency_models.hpp"
+
+namespace BA_Concurrency {
+    struct CoDel {};
+
+    struct CoDel_Config {
+        std::chrono::nanoseconds _target{ std::chrono::nanoseconds::max() }; // disabled by default
+        std::chrono::nanoseconds _interval{ std::chrono::milliseconds(100) };
+        bool _adaptive_lifo{ false };
+
+        bool enabled() const noexcept {
+            return _target != std::chrono::nanoseconds::max();
+        }
+    };
+
+    template <typename T>
+    class Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        CoDel> : public IConcurrent_Queue<T> {
+        using clock_t = std::chrono::steady_clock;
+
+        struct Item {
+            T _data;
+            clock_t::time_point _enqueue_time;
+        };
+
+        // the control law: the next drop time
+        clock_t::time_point control_law(clock_t::time_point time) const noexcept {
+            return time + std::chrono::duration_cast<clock_t::duration>(
+                _config._interval / std::sqrt(static_cast<double>(_count)));
+        }
+
+        // Step 2: returns true if the front item may be dropped
+        bool ok_to_drop(clock_t::time_point now) noexcept {
+            const auto sojourn = now - _items.front()._enqueue_time;
+            if (sojourn < _config._target || _items.size() == 1) {
+                _first_above_time = clock_t::time_point{};
+                return false;
+            }
+            if (_first_above_time == clock_t::time_point{}) {
+                _first_above_time = now + _config._interval;
+                return false;
+            }
+            return now >= _first_above_time;
+        }
+
+        void drop_front(std::vector<T>& dropped) {
+            dropped.push_back(std::move(_items.front()._data));
+            _items.pop_front();
+        }
+
+        // Steps 2 to 4 (the lock is held and the queue is not empty).
+        // returns std::nullopt if all items are dropped.
+        std::optional<T> dequeue(std::vector<T>& dropped) {
+            if (_config.enabled()) {
+                const auto now = clock_t::now();
+                bool drop = ok_to_drop(now);
+
+                // Step 3
+                if (_dropping) {
+                    if (!drop) _dropping = false;
+                    while (_dropping && now >= _drop_next) {
+                        drop_front(dropped);
+                        ++_count;
+                        if (_items.empty() || !ok_to_drop(now)) _dropping = false;
+                        else _drop_next = control_law(_drop_next);
+                    }
+                }
+                else if (drop) {
+                    drop_front(dropped);
+                    _dropping = true;
+                    const bool recent = now - _drop_next < 16 * _config._interval;
+                    _count = _count > 2 && recent ? _count - 2 : 1;
+                    _drop_next = control_law(now);
+                }
+            }
+            if (_items.empty()) return std::nullopt;
+
+            // Step 4
+            if (_dropping && _config._adaptive_lifo) {
+                std::optional<T> data{ std::move(_items.back()._data) };
+                _items.pop_back();
+                return data;
+            }
+            std::optional<T> data{ std::move(_items.front()._data) };
+            _items.pop_front();
+            return data;
+        }
+
+        // Step 5
+        void on_drop(std::vector<T>& dropped) {
+            if (_on_drop)
+                for (auto& data : dropped) _on_drop(std::move(data));
+            _dropped_count.fetch_add(dropped.size(), std::memory_order_relaxed);
+        }
+
+    public:
+
+        explicit Concurrent_Queue(
+            CoDel_Config config = CoDel_Config{},
+            std::function<void(T)> on_drop = {})
+                : _config(config), _on_drop(std::move(on_drop)) {}
+
+        inline void push(T data) override {
+            {
+                std::unique_lock lk(_m);
+                _items.push_back(Item{
+                    std::move(data),
+                    _config.enabled() ? clock_t::now() : clock_t::time_point{} });
+            }
+            _cv.notify_one();
+        }
+
+        // returns std::nullopt if the queue is closed and empty
+        inline std::optional<T> pop() override {
+            std::vector<T> dropped;
+            std::optional<T> data;
+            {
+                std::unique_lock lk(_m);
+                while (true) {
+                    // Step 1
+                    _cv.wait(lk, [&]{ return !_items.empty() || _closed; });
+                    if (_items.empty()) break;
+
+                    // Steps 2 to 4 (wait again if all items are dropped)
+                    data = dequeue(dropped);
+                    if (data) break;
+                }
+            }
+            on_drop(dropped);
+            return data;
+        }
+
+        inline std::optional<T> try_pop() override {
+            std::vector<T> dropped;
+            std::optional<T> data;
+            {
+                std::unique_lock lk(_m);
+                if (!_items.empty()) data = dequeue(dropped);
+            }
+            on_drop(dropped);
+            return data;
+        }
+
+        // wake the waiting consumers: pop returns std::nullopt when the queue is empty
+        void close() {
+            {
+                std::unique_lock lk(_m);
+                _closed = true;
+            }
+            _cv.notify_all();
+        }
+
+        inline size_t size() const noexcept override {
+            std::unique_lock lk(_m);
+            return _items.size();
+        }
+
+        inline bool empty() const noexcept override {
+            std::unique_lock lk(_m);
+            return _items.empty();
+        }
+
+        // the sojourn time of the front item (zero if the AQM is disabled: no timestamps)
+        inline std::chrono::nanoseconds oldest_item_age() const override {
+            std::unique_lock lk(_m);
+            if (!_config.enabled() || _items.empty()) return std::chrono::nanoseconds::zero();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock_t::now() - _items.front()._enqueue_time);
+        }
+
+        // the total number of the dropped items
+        std::size_t dropped_count() const noexcept {
+            return _dropped_count.load(std::memory_order_relaxed);
+        }
+
+        // true while the queue is in the dropping state (overloaded)
+        bool is_dropping() const noexcept {
+            std::unique_lock lk(_m);
+            return _dropping;
+        }
+
+    private:
+
+        // MEMBERS:
+        // The CoDel state (_first_above_time, _drop_next, _count and _dropping) is guarded by _m.
+        const CoDel_Config _config;
+        const std::function<void(T)> _on_drop;
+        std::deque<Item> _items;
+        clock_t::time_point _first_above_time{};
+        clock_t::time_point _drop_next{};
+        std::size_t _count{};
+        bool _dropping{};
+        bool _closed{};
+        std::atomic<std::size_t> _dropped_count{ 0 };
+        mutable std::mutex _m;
+        std::condition_variable _cv;
+    };
+
+    template <typename T>
+    using Concurrent_Queue__Blocking_CoDel = Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        CoDel>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_BLOCKING_CODEL_HPP
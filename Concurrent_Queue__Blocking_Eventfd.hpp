@@ -0,0 +1,184 @@
+// Concurrent_Queue__Blocking_Eventfd.hpp
+//
+// Description:
+//   The blocking MPMC queue (see Concurrent_Queue__Blocking.hpp)
+//   notifying the consumers by an eventfd instead of a condition variable.
+//   The eventfd is readable while the queue is not empty (or closed).
+//   Hence, the queue can be waited together with the file descriptors
+//   (e.g. registered to Reactor, epoll or poll): a single sleep point for the jobs and the I/O.
+//
+// Requirements:
+// - Linux (eventfd).
+// - T must be movable.
+//
+// Design:
+//   The eventfd counter is 1 while the queue is not empty (or closed) and 0 otherwise:
+//     push : signal the eventfd on the transition empty -> not empty
+//     take : drain the eventfd on the transition not empty -> empty
+//     close: signal the eventfd if the queue is empty
+//   The transitions are performed under _m, hence, the counter never exceeds 1.
+//
+// Semantics:
+//   pop:
+//     1. Wait until the eventfd is readable (poll)
+//     2. Take the front item under the lock
+//     3. Retry if another consumer took the item in between
+//   pop returns std::nullopt when the queue is closed and empty.
+//   native_handle returns the eventfd (level-triggered POLLIN/EPOLLIN).
+//
+// Progress:
+//   Blocking
+//
+// Notes:
+//   1. The consumers waiting on the eventfd are all woken by a push (no wake-one semantics).
+//      Prefer a single consumer (e.g. the reactor thread) or Concurrent_Queue__Blocking.
+//
+// Cautions:
+//   1. The reader of native_handle must not read the eventfd (the counter is managed by the queue).
+
+#ifndef CONCURRENT_QUEUE_BLOCKING_EVENTFD_HPP
+#define CONCURRENT_QUEUE_BLOCKING_EVENTFD_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <system_error>
+#include <utility>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "enum_structure_types.hpp"
+#include "enum_concurrency_models.hpp"
+
+namespace BA_Concurrency {
+    struct Eventfd_Notified {};
+
+    template <typename T>
+    class Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Eventfd_Notified> : public IConcurrent_Queue<T> {
+
+        // the lock is held
+        void signal() noexcept {
+            const std::uint64_t one{ 1 };
+            while (::write(_fd, &one, sizeof(one)) < 0 && errno == EINTR);
+        }
+
+        // the lock is held
+        void drain() noexcept {
+            std::uint64_t count;
+            while (::read(_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+        }
+
+        // Step 2 (the lock is held)
+        std::optional<T> take() {
+            if (_queue.empty()) return std::nullopt;
+            std::optional<T> data{ std::move(_queue.front()) };
+            _queue.pop();
+            if (_queue.empty() && !_closed) drain();
+            return data;
+        }
+
+        // Step 1
+        void wait_readable() const noexcept {
+            pollfd pfd{ _fd, POLLIN, 0 };
+            while (::poll(&pfd, 1, -1) < 0 && errno == EINTR);
+        }
+
+    public:
+
+        // throws std::system_error if the eventfd cannot be created (e.g. EMFILE)
+        Concurrent_Queue() : _fd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+            if (_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "Concurrent_Queue: eventfd");
+        }
+
+        // Single-threaded context expected.
+        ~Concurrent_Queue() {
+            ::close(_fd);
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        inline void push(T data) override {
+            std::scoped_lock lk(_m);
+            if (_queue.empty() && !_closed) signal();
+            _queue.push(std::move(data));
+        }
+
+        // returns std::nullopt if the queue is closed and empty
+        inline std::optional<T> pop() override {
+            while (true) {
+                wait_readable();
+
+                // Step 2
+                std::scoped_lock lk(_m);
+                if (!_queue.empty()) return take();
+                if (_closed) return std::nullopt;
+                // Step 3
+            }
+        }
+
+        inline std::optional<T> try_pop() override {
+            std::scoped_lock lk(_m);
+            return take();
+        }
+
+        // wake the waiting consumers: pop returns std::nullopt when the queue is empty
+        void close() {
+            std::scoped_lock lk(_m);
+            if (_closed) return;
+            if (_queue.empty()) signal();
+            _closed = true;
+        }
+
+        bool is_closed() const {
+            std::scoped_lock lk(_m);
+            return _closed;
+        }
+
+        // the eventfd to be waited with the other file descriptors (EPOLLIN)
+        int native_handle() const noexcept {
+            return _fd;
+        }
+
+        inline size_t size() const noexcept override {
+            std::scoped_lock lk(_m);
+            return _queue.size();
+        }
+
+        inline bool empty() const noexcept override {
+            std::scoped_lock lk(_m);
+            return _queue.empty();
+        }
+
+    private:
+
+        // MEMBERS:
+        int _fd;
+        std::queue<T> _queue;
+        bool _closed{ false };
+        mutable std::mutex _m;
+    };
+
+    template <typename T>
+    using Concurrent_Queue__Blocking_Eventfd = Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Eventfd_Notified>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_BLOCKING_EVENTFD_HPP
@@ -0,0 +1,119 @@
+// Concurrent_Queue__Flat_Combining.hpp
+//
+// Description:
+//   The flat-combining version of Concurrent_Queue__Blocking:
+//     The same sequential queue (std::queue) wrapped by Flat_Combiner
+//     instead of the mutex and the condition variable.
+//     The threads publish push and pop operations
+//     and the combiner thread applies them in a batch.
+//
+// Requirements:
+// - T must be movable.
+//
+// Semantics:
+//   push():
+//     1. Publish the operation: queue.push(data) and increment the size
+//     2. Notify a waiting consumer
+//   pop():
+//     Loop:
+//       1. Wait while the size is zero (std::atomic::wait)
+//       2. try_pop() and return the data if succeeds
+//   try_pop():
+//     1. Publish the operation:
+//          IF the queue is empty return std::nullopt
+//          Move the data out from the front, pop and decrement the size
+//
+//   See the documentation of Flat_Combiner.hpp for the details about the flat-combining.
+//
+// Progress:
+//   Blocking:
+//     See the documentation of Flat_Combiner.hpp.
+//
+// Notes:
+//   1. The size is an atomic outside the combiner
+//      so that size(), empty() and the waiting consumers
+//      do not publish an operation.
+//      The size is updated by the combined operations (serialized by the combiner)
+//      so that it never underflows (a pop cannot precede the increment of its push).
+//
+// Cautions:
+//   1. Use Concurrent_Queue__Flat_Combining alias at the end of this file
+//      to get the right specialization of Concurrent_Queue.
+
+#ifndef CONCURRENT_QUEUE_FLAT_COMBINING_HPP
+#define CONCURRENT_QUEUE_FLAT_COMBINING_HPP
+
+#include <cstddef>
+#include <atomic>
+#include <queue>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "Flat_Combiner.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename T,
+        std::size_t Publication_Slot_Count>
+    class Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Flat_Combiner<std::queue<T>, Publication_Slot_Count>> : public IConcurrent_Queue<T> {
+    public:
+        inline void push(T data) override {
+            _queue.apply([this, &data](std::queue<T>& queue) {
+                queue.push(std::move(data));
+                _size.fetch_add(1, std::memory_order_release);
+            });
+            _size.notify_one();
+        }
+
+        inline std::optional<T> pop() override {
+            while (true) {
+                _size.wait(0, std::memory_order_acquire);
+                if (auto data = try_pop(); data.has_value())
+                    return data;
+            }
+        }
+
+        inline std::optional<T> try_pop() override {
+            return _queue.apply([this](std::queue<T>& queue) -> std::optional<T> {
+                if (queue.empty())
+                    return {};
+
+                std::optional<T> data{ std::move(queue.front()) };
+                queue.pop();
+                _size.fetch_sub(1, std::memory_order_relaxed);
+                return data;
+            });
+        }
+
+        inline size_t size() const noexcept override {
+            return _size.load(std::memory_order_acquire);
+        }
+
+        inline bool empty() const noexcept override {
+            return _size.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        Flat_Combiner<std::queue<T>, Publication_Slot_Count> _queue;
+        std::atomic<size_t> _size{0};
+    };
+
+    template <
+        typename T,
+        std::size_t Publication_Slot_Count = FLAT_COMBINING_SLOT_COUNT__DEFAULT>
+    using Concurrent_Queue__Flat_Combining = Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Flat_Combiner<std::queue<T>, Publication_Slot_Count>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_FLAT_COMBINING_HPP
@@ -0,0 +1,350 @@
+// Concurrent_Queue__LF_K_FIFO_MPMC.hpp
+//
+// Description:
+//   The relaxed solution for the lock-free/ring/MPMC queue problem (e.g. the job dispatch):
+//     The ticket ring of Concurrent_Queue__LF_Ring_MPMC.hpp enforces the global FIFO order
+//     by serializing all threads on the shared _head and _tail tickets.
+//     The k-FIFO queue relaxes the order:
+//       The ring is divided into the segments of K slots.
+//       The shared _head and _tail are the segment tickets (not the slot tickets).
+//       The producers and the consumers may pick any slot within the current segment.
+//     Hence, the shared indices are modified once per K operations
+//     and the contention on them drops by a factor of K.
+//
+// Requirements:
+// - T must be noexcept-constructible.
+// - T must be noexcept-movable.
+//
+// Design:
+//   Slot state word: {position, state} where position is the slot ticket of the current lap
+//                    (segment ticket * K + slot index in the segment)
+//     position * 4 + EMPTY  : free for the producer of the position
+//     position * 4 + WRITING: claimed by a producer
+//     position * 4 + FULL   : published for the consumers of the position
+//     position * 4 + READING: claimed by a consumer
+//     After the read, the word moves to the next lap: (position + _CAPACITY) * 4 + EMPTY
+//   The words are monotonic. Hence, the ABA problem is solved by the monotonic positions
+//   as in the ticket ring.
+//
+// Semantics:
+//   push():
+//     1. Load the _tail segment ticket
+//     2. Visit the K slots of the segment starting from the thread local offset
+//        and claim the first EMPTY slot of the lap by CAS(EMPTY, WRITING)
+//     3. Construct the data into the slot and publish it: store(FULL, std::memory_order_release)
+//     4. If no slot is EMPTY:
+//          if a slot is still occupied by the previous lap, the queue is FULL (return false),
+//          otherwise all slots are claimed: advance the _tail by CAS and retry
+//   pop():
+//     1. Load the _head segment ticket
+//     2. Visit the K slots of the segment starting from the thread local offset
+//        and claim the first FULL slot of the lap by CAS(FULL, READING)
+//     3. Move the data out, destroy the object and pass the slot to the next lap
+//     4. If no slot is FULL:
+//          if the _head reached the _tail, the queue is EMPTY (return std::nullopt),
+//          if all slots are consumed, advance the _head by CAS and retry,
+//          otherwise a producer is writing into the segment:
+//            claim the first FULL slot of the following segments up to the _tail
+//            or return std::nullopt
+//
+// Progress:
+//   Lock-free:
+//     A failing CAS on a slot word means another thread claimed the slot.
+//     A failing CAS on a segment ticket means another thread advanced the ticket.
+//   A stalled producer holding a WRITING slot of the _head segment blocks the advance of the _head
+//   but not the consumers: try_pop scans the following segments (at most _CAPACITY slots
+//   as the _tail cannot lap the WRITING slot) and returns std::nullopt if none is FULL.
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//   2. The order deviation:
+//        The items of a segment are popped in any order.
+//        The segments are popped in the FIFO order.
+//        Hence, an item may be overtaken by at most K - 1 items pushed after it
+//        (the other slots of its segment) in a quiescent queue.
+//        Under the contention, the deviation grows with the number of the threads
+//        claiming the slots of the same segment concurrently.
+//        While a producer is stalled in the _head segment,
+//        the items of the following segments overtake its item.
+//   3. The thread local offset spreads the threads over the slots of a segment
+//      avoiding the CAS collisions on the same slot.
+//
+// Cautions:
+//   1. K = 1 reduces to a CAS based ticket ring (the strict FIFO).
+//   2. The queue may report FULL while the other segments have free slots
+//      as the _tail segment must be free for the next lap.
+//   3. size() scans the slots and is intended for monitoring only.
+//   4. Use queue_LF_k_FIFO_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Queue
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider an exponential backoff for the FULL and EMPTY cases of the blocking operations.
+
+#ifndef CONCURRENT_QUEUE_LF_K_FIFO_MPMC_HPP
+#define CONCURRENT_QUEUE_LF_K_FIFO_MPMC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    // use queue_LF_k_FIFO_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Queue
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Segment_Count_As_Pow2,
+        std::size_t K>
+    requires (
+            K > 0 &&
+            std::is_nothrow_constructible_v<T> &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Segment_Count_As_Pow2>,
+        std::integral_constant<std::size_t, K>>
+        : public IConcurrent_Queue<T>
+    {
+        using _CLWA = cache_line_wrapper<std::atomic<std::size_t>>;
+        static constexpr std::size_t _SEGMENT_COUNT = pow2_size<Segment_Count_As_Pow2>;
+        static constexpr std::size_t _CAPACITY      = _SEGMENT_COUNT * K;
+
+        // the slot states (the lower two bits of the slot word)
+        static constexpr std::size_t _EMPTY   = 0;
+        static constexpr std::size_t _WRITING = 1;
+        static constexpr std::size_t _FULL    = 2;
+        static constexpr std::size_t _READING = 3;
+
+        struct Slot {
+            std::atomic<std::size_t> _word;
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        static constexpr std::size_t word(std::size_t position, std::size_t state) noexcept {
+            return position * 4 + state;
+        }
+
+        // the thread local offset within the segments
+        // (assigned round-robin as the thread ids are not well distributed modulo K)
+        static std::size_t offset() noexcept {
+            static std::atomic<std::size_t> thread_count{ 0 };
+            static thread_local const std::size_t offset_ =
+                thread_count.fetch_add(1, std::memory_order_relaxed) % K;
+            return offset_;
+        }
+
+        Slot& slot_of(std::size_t position) noexcept {
+            return _slots[position % _CAPACITY];
+        }
+
+        // Steps 2 and 3 of try_pop:
+        // claim the first FULL slot of the segment starting from the thread local offset.
+        // is_consumed is cleared if a slot of the segment is EMPTY or WRITING.
+        std::optional<T> try_pop_from(
+            std::size_t segment,
+            bool& is_consumed) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            for (std::size_t i = 0; i < K; ++i) {
+                const std::size_t position = segment * K + (offset() + i) % K;
+                Slot& slot = slot_of(position);
+                std::size_t slot_word = slot._word.load(std::memory_order_acquire);
+                if (slot_word < word(position, _FULL)) {
+                    is_consumed = false; // EMPTY or WRITING
+                    continue;
+                }
+                if (
+                    slot_word != word(position, _FULL) ||
+                    !slot._word.compare_exchange_strong(
+                        slot_word,
+                        word(position, _READING),
+                        std::memory_order_acquire,
+                        std::memory_order_relaxed))
+                    continue;
+
+                // Step 3
+                T* ptr = slot.to_ptr();
+                std::optional<T> data{ std::move(*ptr) };
+                if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+                slot._word.store(word(position + _CAPACITY, _EMPTY), std::memory_order_release);
+                return data;
+            }
+            return std::nullopt;
+        }
+
+    public:
+
+        Concurrent_Queue() noexcept {
+            for (std::size_t i = 0; i < _CAPACITY; ++i)
+                _slots[i]._word.store(word(i, _EMPTY), std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        // destroy the elements that were pushed but not yet popped
+        ~Concurrent_Queue() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (auto& slot : _slots)
+                    if ((slot._word.load(std::memory_order_relaxed) & 3) == _FULL)
+                        slot.to_ptr()->~T();
+            }
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        // Blocking enqueue: busy-wait while FULL.
+        void push(T data) noexcept(std::is_nothrow_constructible_v<T>) override {
+            while (!try_push(std::move(data))) std::this_thread::yield();
+        }
+
+        // Blocking dequeue: busy-wait while EMPTY.
+        std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            while (true) {
+                if (auto data = try_pop(); data.has_value()) return data;
+                std::this_thread::yield();
+            }
+        }
+
+        // Non-blocking enqueue: Returns false if FULL.
+        //   1. Load the _tail segment ticket
+        //   2. Claim the first EMPTY slot of the segment starting from the thread local offset
+        //   3. Construct the data into the slot and publish it
+        //   4. If no slot is EMPTY, return false if FULL or advance the _tail and retry
+        template <class U>
+        bool try_push(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            while (true) {
+                // Step 1
+                std::size_t segment = _tail.value.load(std::memory_order_acquire);
+
+                // Step 2
+                bool is_full{};
+                for (std::size_t i = 0; i < K; ++i) {
+                    const std::size_t position = segment * K + (offset() + i) % K;
+                    Slot& slot = slot_of(position);
+                    std::size_t slot_word = slot._word.load(std::memory_order_acquire);
+                    if (slot_word < word(position, _EMPTY)) {
+                        is_full = true; // occupied by the previous lap
+                        continue;
+                    }
+                    if (
+                        slot_word != word(position, _EMPTY) ||
+                        !slot._word.compare_exchange_strong(
+                            slot_word,
+                            word(position, _WRITING),
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                        continue;
+
+                    // Step 3
+                    ::new (slot.to_ptr()) T(std::forward<U>(data));
+                    slot._word.store(word(position, _FULL), std::memory_order_release);
+                    return true;
+                }
+
+                // Step 4
+                if (is_full) return false;
+                _tail.value.compare_exchange_strong(
+                    segment,
+                    segment + 1,
+                    std::memory_order_acq_rel,
+                    std::memory_order_relaxed);
+            }
+        }
+
+        // Non-blocking dequeue: Returns nullopt if EMPTY.
+        //   1. Load the _head segment ticket
+        //   2. Claim the first FULL slot of the segment starting from the thread local offset
+        //   3. Move the data out, destroy the object and pass the slot to the next lap
+        //   4. If no slot is FULL, return std::nullopt if EMPTY or advance the _head and retry
+        //      (a producer writing into the _head segment: pop from the following segments)
+        std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            while (true) {
+                // Step 1
+                std::size_t segment = _head.value.load(std::memory_order_acquire);
+
+                // Steps 2 and 3
+                bool is_consumed{ true };
+                if (auto data = try_pop_from(segment, is_consumed); data.has_value()) return data;
+
+                // Step 4
+                const std::size_t tail = _tail.value.load(std::memory_order_acquire);
+                if (segment == tail) return std::nullopt;
+                if (is_consumed) {
+                    _head.value.compare_exchange_strong(
+                        segment,
+                        segment + 1,
+                        std::memory_order_acq_rel,
+                        std::memory_order_relaxed);
+                    continue;
+                }
+
+                // a producer is writing into the _head segment (see Progress in the header documentation)
+                for (std::size_t next = segment + 1; next <= tail; ++next)
+                    if (auto data = try_pop_from(next, is_consumed); data.has_value()) return data;
+                return std::nullopt;
+            }
+        }
+
+        // the number of the FULL slots (scans the slots, see Caution 3)
+        inline size_t size() const noexcept override {
+            std::size_t size{};
+            for (const auto& slot : _slots)
+                size += (slot._word.load(std::memory_order_acquire) & 3) == _FULL;
+            return size;
+        }
+
+        inline bool empty() const noexcept override {
+            return
+                _head.value.load(std::memory_order_acquire) ==
+                _tail.value.load(std::memory_order_acquire) &&
+                size() == 0;
+        }
+
+        inline std::size_t capacity() const noexcept { return _CAPACITY; }
+
+        static constexpr std::size_t segment_size() noexcept { return K; }
+
+    private:
+
+        // MEMBERS:
+        // The segment tickets:
+        //   _head: the segment being popped
+        //   _tail: the segment being pushed
+        // _head <= _tail as the _head is advanced only behind the _tail.
+        _CLWA _head{ 0 };
+        _CLWA _tail{ 0 };
+        Slot _slots[_CAPACITY];
+    };
+
+    template <
+        typename T,
+        unsigned char Segment_Count_As_Pow2,
+        std::size_t K>
+    using queue_LF_k_FIFO_MPMC = Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Segment_Count_As_Pow2>,
+        std::integral_constant<std::size_t, K>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_LF_K_FIFO_MPMC_HPP
@@ -0,0 +1,384 @@
+// Concurrent_Queue__LF_Linked_Ring_MPMC.hpp
+//
+// Description:
+//   The unbounded solution for the lock-free/ring/MPMC queue problem:
+//     The ticket ring of Concurrent_Queue__LF_Ring_MPMC.hpp is bounded
+//     and a stalled thread blocks its reserved slot.
+//     This queue chains the ring segments (LCRQ/SCQ style):
+//       The threads obtain the slot tickets by fetch_add within the current segment (the fast path).
+//       A segment is closed when its tickets are exhausted and
+//       a new segment is linked to the closed one.
+//       A consumer which finds its slot not yet written poisons the slot
+//       and the late producer retries with another ticket.
+//     Hence, neither a producer spins on a FULL queue nor a consumer spins on a reserved slot.
+//     The closed segments are retired through the hazard pointers.
+//
+// Requirements:
+// - T must be noexcept-constructible.
+// - T must be noexcept-movable.
+//
+// Design:
+//   Segment:
+//     _base_ticket: the global ticket of the first slot of the segment (used by size())
+//     _enq_index  : the producer ticket within the segment (fetch_add)
+//     _deq_index  : the consumer ticket within the segment (fetch_add)
+//     _next       : the next segment
+//     _slots      : the slots with the states EMPTY, FULL and TAKEN
+//   Slot states:
+//     EMPTY -> FULL : the producer has published the data
+//     EMPTY -> TAKEN: the consumer has poisoned the slot before the producer
+//     FULL  -> TAKEN: the consumer has taken the data
+//
+// Semantics:
+//   push():
+//     1. Protect the _tail segment by the hazard ptr
+//     2. Obtain the producer ticket: segment._enq_index.fetch_add(1)
+//     3. If the ticket is in the segment:
+//          Construct the data into the slot and publish it by CAS(EMPTY, FULL)
+//          If the slot is poisoned, move the data back and retry from Step 1
+//     4. Otherwise the segment is closed:
+//          Link a new segment holding the data in its first slot by CAS(segment._next, nullptr, new_segment)
+//          and advance the _tail (or help advancing the _tail if another producer was faster)
+//   pop():
+//     1. Protect the _head segment by the hazard ptr
+//     2. Return std::nullopt if the segment is drained and there is no next segment
+//     3. Obtain the consumer ticket: segment._deq_index.fetch_add(1)
+//     4. If the ticket is in the segment:
+//          Take the slot by exchange(TAKEN)
+//          If the slot was FULL, move the data out and return it
+//          Otherwise the slot is poisoned: retry from Step 1
+//     5. Otherwise the segment is closed and drained:
+//          Advance the _tail if it lags on the segment,
+//          advance the _head by CAS and retire the segment through the hazard ptrs
+//
+// Progress:
+//   Lock-free:
+//     A failing CAS on _head, _tail or _next means another thread made progress.
+//     A poisoned slot means a consumer has consumed a ticket
+//     (a consumer racing with a slow producer may poison repeatedly
+//     but the system as a whole progresses).
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//      The hazard ptr publication and the validating re-load are separated
+//      by a sequentially consistent fence (store-load ordering).
+//   2. The _tail never points to a retired segment:
+//      the consumer advances the _tail before advancing the _head past the segment.
+//   3. The fast path of both operations is a single fetch_add on the segment ticket
+//      and a single atomic operation on the slot state.
+//
+// Cautions:
+//   1. Hazard_Ptr_Owner shares a single hazard ptr record per thread.
+//      Hence, push and pop shall not be called re-entrantly from a thread
+//      (e.g. from the move constructor of T).
+//   2. size() is approximate: the poisoned slots are counted as well.
+//   3. Use queue_LF_linked_ring_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Queue
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider recycling the retired segments instead of deallocating them.
+//   2. Defered reclamation is per thread base (see Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp).
+
+#ifndef CONCURRENT_QUEUE_LF_LINKED_RING_MPMC_HPP
+#define CONCURRENT_QUEUE_LF_LINKED_RING_MPMC_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "enum_memory_reclaimers.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+#include "Hazard_Ptr.hpp"
+
+namespace BA_Concurrency {
+    // use queue_LF_linked_ring_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Queue
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Segment_Size_As_Pow2,
+        std::size_t Hazard_Ptr_Record_Count>
+    requires (
+            std::is_nothrow_constructible_v<T> &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Dynamic_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Segment_Size_As_Pow2>,
+        std::integral_constant<std::uint8_t, static_cast<std::uint8_t>(Enum_Memory_Reclaimers::Hazard_Ptr)>,
+        std::integral_constant<std::size_t, Hazard_Ptr_Record_Count>>
+        : public IConcurrent_Queue<T>
+    {
+        using _CLWA = cache_line_wrapper<std::atomic<std::size_t>>;
+        static constexpr std::size_t _SEGMENT_SIZE = pow2_size<Segment_Size_As_Pow2>;
+
+        // local aliases
+        using _HPO = Hazard_Ptr_Owner<Hazard_Ptr_Record_Count>;
+
+        // the slot states
+        static constexpr std::uint8_t _EMPTY = 0;
+        static constexpr std::uint8_t _FULL  = 1;
+        static constexpr std::uint8_t _TAKEN = 2;
+
+        struct Slot {
+            std::atomic<std::uint8_t> _state{ _EMPTY };
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        struct Segment {
+            const std::size_t _base_ticket;
+            _CLWA _enq_index{ 0 };
+            _CLWA _deq_index{ 0 };
+            std::atomic<Segment*> _next{ nullptr };
+            Slot _slots[_SEGMENT_SIZE];
+
+            explicit Segment(std::size_t base_ticket) noexcept : _base_ticket(base_ticket) {}
+            ~Segment() {
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    for (auto& slot : _slots)
+                        if (slot._state.load(std::memory_order_relaxed) == _FULL)
+                            slot.to_ptr()->~T();
+                }
+            }
+
+            bool is_drained() const noexcept {
+                return
+                    _deq_index.value.load(std::memory_order_acquire) >=
+                    _enq_index.value.load(std::memory_order_acquire);
+            }
+        };
+
+        // deleter to be supplied to Hazard_Ptr_Owner for deferred reclamation
+        static void delete_segment(void *ptr, void *) {
+            delete static_cast<Segment*>(ptr);
+        }
+
+        // Step 1 of push and pop: protect the segment loaded from the source and validate
+        static Segment* protect(const _HPO& hazard_ptr_owner, const std::atomic<Segment*>& source) noexcept {
+            Segment* segment = source.load(std::memory_order_acquire);
+            Segment* temp;
+            do {
+                temp = segment;
+                hazard_ptr_owner.protect(segment);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                segment = source.load(std::memory_order_acquire);
+            } while (segment != temp);
+            return segment;
+        }
+
+    public:
+
+        Concurrent_Queue() {
+            auto* segment = new Segment(0);
+            _head.value.store(segment, std::memory_order_relaxed);
+            _tail.value.store(segment, std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        ~Concurrent_Queue() {
+            Segment* segment = _head.value.load(std::memory_order_relaxed);
+            while (segment) {
+                Segment* next = segment->_next.load(std::memory_order_relaxed);
+                delete segment;
+                segment = next;
+            }
+
+            // TODO:
+            //   Defered reclamation is per thread base (see Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp).
+            _HPO::try_reclaim_memory();
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        // Unbounded enqueue: never waits for the consumers.
+        //   1. Protect the _tail segment by the hazard ptr
+        //   2. Obtain the producer ticket
+        //   3. If the ticket is in the segment, publish the data by CAS(EMPTY, FULL)
+        //   4. Otherwise link a new segment holding the data and advance the _tail
+        void push(T data) override {
+            _HPO hazard_ptr_owner;
+            while (true) {
+                // Step 1
+                Segment* segment = protect(hazard_ptr_owner, _tail.value);
+
+                // Step 2
+                const std::size_t index = segment->_enq_index.value.fetch_add(1, std::memory_order_acq_rel);
+
+                // Step 3
+                if (index < _SEGMENT_SIZE) {
+                    Slot& slot = segment->_slots[index];
+                    T* ptr = ::new (slot.to_ptr()) T(std::move(data));
+                    std::uint8_t state = _EMPTY;
+                    if (
+                        slot._state.compare_exchange_strong(
+                            state,
+                            _FULL,
+                            std::memory_order_release,
+                            std::memory_order_relaxed))
+                        return;
+
+                    // poisoned by a consumer: take the data back and retry
+                    data = std::move(*ptr);
+                    if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+                    continue;
+                }
+
+                // Step 4
+                Segment* next = segment->_next.load(std::memory_order_acquire);
+                if (!next) {
+                    auto* new_segment = new Segment(segment->_base_ticket + _SEGMENT_SIZE);
+                    ::new (new_segment->_slots[0].to_ptr()) T(std::move(data));
+                    new_segment->_slots[0]._state.store(_FULL, std::memory_order_relaxed);
+                    new_segment->_enq_index.value.store(1, std::memory_order_relaxed);
+                    if (
+                        segment->_next.compare_exchange_strong(
+                            next,
+                            new_segment,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        _tail.value.compare_exchange_strong(
+                            segment,
+                            new_segment,
+                            std::memory_order_acq_rel,
+                            std::memory_order_relaxed);
+                        return;
+                    }
+
+                    // another producer was faster: take the data back
+                    data = std::move(*new_segment->_slots[0].to_ptr());
+                    delete new_segment;
+                }
+                _tail.value.compare_exchange_strong(
+                    segment,
+                    next,
+                    std::memory_order_acq_rel,
+                    std::memory_order_relaxed);
+            }
+        }
+
+        // Blocking dequeue: busy-wait while EMPTY.
+        std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            while (true) {
+                if (auto data = try_pop(); data.has_value()) return data;
+                std::this_thread::yield();
+            }
+        }
+
+        // Non-blocking dequeue: Returns nullopt if EMPTY.
+        //   1. Protect the _head segment by the hazard ptr
+        //   2. Return std::nullopt if the segment is drained and there is no next segment
+        //   3. Obtain the consumer ticket
+        //   4. If the ticket is in the segment, take the slot by exchange(TAKEN)
+        //   5. Otherwise advance the _head and retire the segment
+        std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            _HPO hazard_ptr_owner;
+            while (true) {
+                // Step 1
+                Segment* segment = protect(hazard_ptr_owner, _head.value);
+
+                // Step 2
+                if (segment->is_drained() && !segment->_next.load(std::memory_order_acquire))
+                    return std::nullopt;
+
+                // Step 3
+                const std::size_t index = segment->_deq_index.value.fetch_add(1, std::memory_order_acq_rel);
+
+                // Step 4
+                if (index < _SEGMENT_SIZE) {
+                    Slot& slot = segment->_slots[index];
+                    if (slot._state.exchange(_TAKEN, std::memory_order_acq_rel) != _FULL)
+                        continue; // poisoned: the producer will retry with another ticket
+
+                    T* ptr = slot.to_ptr();
+                    std::optional<T> data{ std::move(*ptr) };
+                    if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+                    return data;
+                }
+
+                // Step 5
+                Segment* next = segment->_next.load(std::memory_order_acquire);
+                if (!next) return std::nullopt;
+
+                // the _tail shall not point to a retired segment
+                Segment* tail = segment;
+                _tail.value.compare_exchange_strong(
+                    tail,
+                    next,
+                    std::memory_order_acq_rel,
+                    std::memory_order_relaxed);
+                if (
+                    _head.value.compare_exchange_strong(
+                        segment,
+                        next,
+                        std::memory_order_acq_rel,
+                        std::memory_order_relaxed))
+                {
+                    hazard_ptr_owner.clear();
+                    _HPO::reclaim_memory_later(static_cast<void*>(segment), nullptr, &delete_segment);
+                }
+            }
+        }
+
+        // the approximate size (see Caution 2 in the header documentation)
+        inline size_t size() const noexcept override {
+            _HPO hazard_ptr_owner;
+            const Segment* tail = protect(hazard_ptr_owner, _tail.value);
+            const std::size_t enq_ticket =
+                tail->_base_ticket +
+                std::min(tail->_enq_index.value.load(std::memory_order_acquire), _SEGMENT_SIZE);
+            const Segment* head = protect(hazard_ptr_owner, _head.value);
+            const std::size_t deq_ticket =
+                head->_base_ticket +
+                std::min(head->_deq_index.value.load(std::memory_order_acquire), _SEGMENT_SIZE);
+            return enq_ticket > deq_ticket ? enq_ticket - deq_ticket : 0;
+        }
+
+        inline bool empty() const noexcept override {
+            _HPO hazard_ptr_owner;
+            const Segment* head = protect(hazard_ptr_owner, _head.value);
+            return head->is_drained() && !head->_next.load(std::memory_order_acquire);
+        }
+
+    private:
+
+        // MEMBERS:
+        // The _head and the _tail segments are separated
+        // as the producers and the consumers shall not interfere.
+        cache_line_wrapper<std::atomic<Segment*>> _head{ nullptr };
+        cache_line_wrapper<std::atomic<Segment*>> _tail{ nullptr };
+    };
+
+    template <
+        typename T,
+        unsigned char Segment_Size_As_Pow2 = 10,
+        std::size_t Hazard_Ptr_Record_Count = HAZARD_PTR_RECORD_COUNT__DEFAULT>
+    using queue_LF_linked_ring_MPMC = Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Dynamic_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Segment_Size_As_Pow2>,
+        std::integral_constant<std::uint8_t, static_cast<std::uint8_t>(Enum_Memory_Reclaimers::Hazard_Ptr)>,
+        std::integral_constant<std::size_t, Hazard_Ptr_Record_Count>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_LF_LINKED_RING_MPMC_HPP
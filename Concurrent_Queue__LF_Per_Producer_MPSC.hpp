@@ -0,0 +1,390 @@
+// Concurrent_Queue__LF_Per_Producer_MPSC.hpp
+//
+// CAUTION:
+//   I created this repository as a reference for my job applications.
+//   The code given in this repository is:
+//     - to introduce my experience with lock-free concurrency, atomic operations and the required C++ utilities,
+//     - to present my background with the concurrent data structures,
+//     - not to provide a tested production-ready multi-platform library.
+//
+// Description:
+//   The work-aggregating solution for the lock-free/ring/MPSC queue problem
+//   (e.g. a logging or a metrics sink receiving small records from all workers):
+//     Each producer thread writes into its own SPSC ring buffer.
+//     The buffers are registered in a lock-free producer list
+//     and the single consumer round-robins over the buffers.
+//     Hence, there exist no producer-producer atomics at all
+//     (compare with the shared _tail ticket of Concurrent_Queue__LF_Ring_MPSC.hpp).
+//     This is an alternative mode of queue_LF_ring_MPSC for the MPSC fan-in.
+//
+// Requirements:
+// - T must be noexcept-constructible.
+// - T must be noexcept-movable.
+//
+// Design:
+//   Producer_Buffer:
+//     An SPSC ring buffer with:
+//       _head       : the consumer index
+//       _tail       : the producer index
+//       _cached_head: the producer's copy of the consumer index
+//                     (the producer reads _head only when the cached value shows a full buffer)
+//       _alive      : cleared when the producer thread exits
+//       _queue_alive: cleared when the queue is destroyed
+//       _refs       : the shared ownership of the producer thread and the queue
+//       _next       : the next buffer in the producer list
+//   The buffer of a producer thread is located by a thread local map
+//   keyed by the unique id of the queue (not by the address which may be reused).
+//   The thread local map releases the buffers of the thread at the thread exit.
+//   A destroyed queue clears _queue_alive of its buffers and increments PER_PRODUCER_QUEUE_DEATHS.
+//   The thread local map drops the buffers of the destroyed queues
+//   at the next push of the thread observing a new value of PER_PRODUCER_QUEUE_DEATHS.
+//
+// Semantics:
+//   push():
+//     1. Get the buffer of this thread (registers a new buffer at the first push):
+//          drop the buffers of the destroyed queues (if any)
+//          the registration is a CAS push to the head of the producer list
+//     2. Spin while the buffer is full
+//     3. Construct the data into the slot at _tail
+//     4. Publish the data: _tail.store(tail + 1, std::memory_order_release)
+//   try_pop() (consumer only):
+//     1. Visit the buffers starting from the round-robin cursor
+//     2. Pop from the first non-empty buffer:
+//          move the data out of the slot at _head and
+//          release the slot: _head.store(head + 1, std::memory_order_release)
+//     3. Move the cursor to the next buffer (fairness)
+//     4. If all buffers are empty, collect the buffers of the exited producers
+//   pop() (consumer only):
+//     Spin on try_pop (yield between the trials).
+//
+// Progress:
+//   push   : wait-free if the buffer is not full
+//            (lock-free registration at the first push and after a queue is destroyed)
+//   try_pop: wait-free on the number of the registered buffers
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the index updates and
+//      to acquire data after observing the index updates.
+//   2. The consumer is the only thread unlinking the buffers.
+//      The producers only push to the head of the list.
+//      Hence, the consumer never unlinks the head buffer
+//      which is collected after a new buffer is registered.
+//   3. The FIFO order is preserved per producer but not across the producers.
+//
+// Cautions:
+//   1. pop, try_pop, size and empty must be called by the single consumer thread.
+//   2. push and try_push throw std::bad_alloc if the registration fails to allocate
+//      (the queue and the thread local map are unchanged).
+//   3. A producer thread keeps the buffer of a destroyed queue (the slots and the unpopped data)
+//      until its next push to a queue of the same type (or its exit).
+//   4. Use queue_LF_per_producer_MPSC alias at the end of this file
+//      to get the right specialization of Concurrent_Queue
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider an exponential backoff for the full buffer and the empty queue cases.
+
+#ifndef CONCURRENT_QUEUE_LF_PER_PRODUCER_MPSC_HPP
+#define CONCURRENT_QUEUE_LF_PER_PRODUCER_MPSC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    // the specialization key of the per-producer buffer mode of the ring MPSC queue
+    struct Per_Producer_Buffers {};
+
+    // the unique ids of the queues used by the thread local buffer maps
+    inline std::atomic<std::uint64_t> PER_PRODUCER_QUEUE_ID{ 0 };
+
+    // the number of the destroyed queues: the thread local buffer maps drop the stale buffers when changed
+    inline std::atomic<std::uint64_t> PER_PRODUCER_QUEUE_DEATHS{ 0 };
+
+    // use queue_LF_per_producer_MPSC alias at the end of this file
+    // to get the right specialization of Concurrent_Queue
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    requires (
+            std::is_nothrow_constructible_v<T> &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPSC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>,
+        Per_Producer_Buffers>
+        : public IConcurrent_Queue<T>
+    {
+        using _CLWA = cache_line_wrapper<std::atomic<std::size_t>>;
+        static constexpr std::size_t _CAPACITY = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::size_t _MASK     = _CAPACITY - 1;
+
+        struct Slot {
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        struct Producer_Buffer {
+            _CLWA _head{ 0 }; // next index to pop
+            _CLWA _tail{ 0 }; // next index to push
+            std::size_t _cached_head{}; // on the producer's cache line with _tail
+            std::atomic<bool> _alive{ true };
+            std::atomic<bool> _queue_alive{ true };
+            std::atomic<int> _refs{ 2 }; // the producer thread and the queue
+            std::atomic<Producer_Buffer*> _next{ nullptr };
+            Slot _slots[_CAPACITY];
+
+            ~Producer_Buffer() {
+                if constexpr (!std::is_trivially_destructible_v<T>) {
+                    const std::size_t tail = _tail.value.load(std::memory_order_relaxed);
+                    for (std::size_t head = _head.value.load(std::memory_order_relaxed); head != tail; ++head)
+                        _slots[head & _MASK].to_ptr()->~T();
+                }
+            }
+
+            bool empty() const noexcept {
+                return
+                    _head.value.load(std::memory_order_relaxed) ==
+                    _tail.value.load(std::memory_order_acquire);
+            }
+        };
+
+        // release a reference to the buffer (the producer thread or the queue)
+        static void release(Producer_Buffer* buffer) noexcept {
+            if (buffer->_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete buffer;
+        }
+
+        // the buffers of this thread keyed by the queue ids.
+        // releases the buffers at the thread exit.
+        struct Thread_Buffers {
+            std::unordered_map<std::uint64_t, Producer_Buffer*> _buffers;
+            std::uint64_t _queue_deaths{}; // the last observed PER_PRODUCER_QUEUE_DEATHS
+
+            // drop the buffers of the destroyed queues
+            void drop_dead_queues() noexcept {
+                const std::uint64_t queue_deaths = PER_PRODUCER_QUEUE_DEATHS.load(std::memory_order_acquire);
+                if (queue_deaths == _queue_deaths) return;
+                _queue_deaths = queue_deaths;
+                std::erase_if(_buffers, [](const auto& entry) {
+                    if (entry.second->_queue_alive.load(std::memory_order_acquire)) return false;
+                    release(entry.second);
+                    return true;
+                });
+            }
+
+            ~Thread_Buffers() {
+                for (auto& [id, buffer] : _buffers) {
+                    buffer->_alive.store(false, std::memory_order_release);
+                    release(buffer);
+                }
+            }
+        };
+
+        // Step 1 of push: get (or register) the buffer of this thread.
+        // throws std::bad_alloc if the registration fails (see Cautions 2).
+        Producer_Buffer& get_buffer() {
+            static thread_local Thread_Buffers thread_buffers;
+            thread_buffers.drop_dead_queues();
+            if (auto it = thread_buffers._buffers.find(_id); it != thread_buffers._buffers.end())
+                return *it->second;
+
+            auto* buffer = new Producer_Buffer;
+            try {
+                thread_buffers._buffers.emplace(_id, buffer);
+            }
+            catch (...) {
+                delete buffer;
+                throw;
+            }
+            Producer_Buffer* head = _buffers.value.load(std::memory_order_relaxed);
+            do {
+                buffer->_next.store(head, std::memory_order_relaxed);
+            } while (
+                !_buffers.value.compare_exchange_weak(
+                    head,
+                    buffer,
+                    std::memory_order_release,
+                    std::memory_order_relaxed));
+            return *buffer;
+        }
+
+        // Step 2 of try_pop
+        static std::optional<T> pop_from(Producer_Buffer& buffer) noexcept {
+            const std::size_t head = buffer._head.value.load(std::memory_order_relaxed);
+            if (head == buffer._tail.value.load(std::memory_order_acquire)) return std::nullopt;
+            T* ptr = buffer._slots[head & _MASK].to_ptr();
+            std::optional<T> data{ std::move(*ptr) };
+            if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+            buffer._head.value.store(head + 1, std::memory_order_release);
+            return data;
+        }
+
+        // Step 4 of try_pop: unlink and release the empty buffers of the exited producers.
+        // the head buffer is never unlinked (see Note 2 in the header documentation).
+        void collect() noexcept {
+            Producer_Buffer* prev = _buffers.value.load(std::memory_order_acquire);
+            if (!prev) return;
+            Producer_Buffer* buffer = prev->_next.load(std::memory_order_acquire);
+            while (buffer) {
+                Producer_Buffer* next = buffer->_next.load(std::memory_order_acquire);
+                if (!buffer->_alive.load(std::memory_order_acquire) && buffer->empty()) {
+                    prev->_next.store(next, std::memory_order_relaxed);
+                    release(buffer);
+                }
+                else prev = buffer;
+                buffer = next;
+            }
+            _cursor = nullptr;
+        }
+
+    public:
+
+        Concurrent_Queue() noexcept = default;
+
+        // Single-threaded context expected.
+        // release the buffers (the exited producers' buffers are deleted)
+        // and let the live producers drop theirs (see Cautions 3).
+        ~Concurrent_Queue() {
+            Producer_Buffer* buffer = _buffers.value.load(std::memory_order_acquire);
+            while (buffer) {
+                Producer_Buffer* next = buffer->_next.load(std::memory_order_relaxed);
+                buffer->_queue_alive.store(false, std::memory_order_release);
+                release(buffer);
+                buffer = next;
+            }
+            PER_PRODUCER_QUEUE_DEATHS.fetch_add(1, std::memory_order_release);
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        // Blocking enqueue: busy-wait while the buffer of this thread is FULL.
+        //   1. Get the buffer of this thread
+        //   2. Spin while the buffer is full
+        //   3. Construct the data into the slot at _tail
+        //   4. Publish the data
+        // throws std::bad_alloc at the registration (see Cautions 2)
+        void push(T data) override {
+            while (!try_push(std::move(data)));
+        }
+
+        // Non-blocking enqueue: Returns false if the buffer of this thread is FULL.
+        // throws std::bad_alloc at the registration (see Cautions 2)
+        template <class U>
+        bool try_push(U&& data) {
+            // Step 1
+            Producer_Buffer& buffer = get_buffer();
+
+            // Step 2
+            const std::size_t tail = buffer._tail.value.load(std::memory_order_relaxed);
+            if (tail - buffer._cached_head == _CAPACITY) {
+                buffer._cached_head = buffer._head.value.load(std::memory_order_acquire);
+                if (tail - buffer._cached_head == _CAPACITY) return false;
+            }
+
+            // Step 3
+            ::new (buffer._slots[tail & _MASK].to_ptr()) T(std::forward<U>(data));
+
+            // Step 4
+            buffer._tail.value.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Blocking dequeue (consumer only): yields while all buffers are EMPTY.
+        std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            while (true) {
+                if (auto data = try_pop(); data.has_value()) return data;
+                std::this_thread::yield();
+            }
+        }
+
+        // Non-blocking dequeue (consumer only): Returns nullopt if all buffers are EMPTY.
+        //   1. Visit the buffers starting from the round-robin cursor
+        //   2. Pop from the first non-empty buffer
+        //   3. Move the cursor to the next buffer
+        //   4. If all buffers are empty, collect the buffers of the exited producers
+        std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            Producer_Buffer* head = _buffers.value.load(std::memory_order_acquire);
+            if (!head) return std::nullopt;
+
+            // Step 1: visit [cursor, end) and then [head, cursor)
+            Producer_Buffer* const start = _cursor ? _cursor : head;
+            Producer_Buffer* buffer = start;
+            do {
+                // Step 2
+                if (auto data = pop_from(*buffer); data.has_value()) {
+                    // Step 3
+                    _cursor = buffer->_next.load(std::memory_order_acquire);
+                    return data;
+                }
+                buffer = buffer->_next.load(std::memory_order_acquire);
+                if (!buffer) buffer = head;
+            } while (buffer != start);
+
+            // Step 4
+            collect();
+            return std::nullopt;
+        }
+
+        // the approximate size (consumer only)
+        inline size_t size() const noexcept override {
+            std::size_t size{};
+            for (
+                Producer_Buffer* buffer = _buffers.value.load(std::memory_order_acquire);
+                buffer;
+                buffer = buffer->_next.load(std::memory_order_acquire))
+                size +=
+                    buffer->_tail.value.load(std::memory_order_acquire) -
+                    buffer->_head.value.load(std::memory_order_relaxed);
+            return size;
+        }
+
+        inline bool empty() const noexcept override {
+            return size() == 0;
+        }
+
+        // the capacity per producer
+        inline std::size_t capacity() const noexcept { return _CAPACITY; }
+
+    private:
+
+        // MEMBERS:
+        // The producer list is modified by the registrations only.
+        // The cursor is owned by the consumer.
+        const std::uint64_t _id{ PER_PRODUCER_QUEUE_ID.fetch_add(1, std::memory_order_relaxed) };
+        cache_line_wrapper<std::atomic<Producer_Buffer*>> _buffers{ nullptr };
+        Producer_Buffer* _cursor{};
+    };
+
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    using queue_LF_per_producer_MPSC = Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPSC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>,
+        Per_Producer_Buffers>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_LF_PER_PRODUCER_MPSC_HPP
@@ -182,7 +182,12 @@
 //      to acquire data after observing the state transitions.
 //   2. push(): Back-pressures when the queue is full by spinning on its reserved slot.
 //      pop(): Back-pressures when the queue is empty by spinning on its reserved slot.
-//   3. The optimizations for single producer/consumer configurations
+//   3. The monitoring (see Queue_Monitor.hpp) is enabled by the constructor taking a monitor:
+//        push stores a timestamp into the slot before the publication and
+//        push and pop report the approximate depth to the monitor.
+//      Without a monitor, the hot path costs a single predictable branch.
+//      approximate_size derives the depth from the tickets (two relaxed loads).
+//   4. The optimizations for single producer/consumer configurations
 //      can be found in the following header files:
 //        queue_LF_ring_MPSC.hpp
 //        queue_LF_ring_SPMC.hpp
@@ -218,6 +223,7 @@
 #include "Concurrent_Queue.hpp"
 #include "aux_type_traits.hpp"
 #include "cache_line_wrapper.hpp"
+#include "Queue_Monitor.hpp"
 
 namespace BA_Concurrency {
     // use queue_LF_ring_MPMC alias at the end of this file
@@ -250,6 +256,7 @@ namespace BA_Concurrency {
         // aligned to prevent false sharing
         struct alignas(64) Slot {
             std::atomic<std::size_t> _expected_ticket;
+            std::atomic<std::int64_t> _push_time{ 0 }; // written if monitored
             alignas(T) unsigned char _data[sizeof(T)];
             T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
         };
@@ -263,13 +270,18 @@ namespace BA_Concurrency {
             }
         }
 
+        // The monitored queue: see Queue_Monitor.hpp
+        explicit Concurrent_Queue(Queue_Monitor& monitor) noexcept : Concurrent_Queue() {
+            _monitor = &monitor;
+        }
+
         // Single-threaded context expected.
         // destroy the elements that were enqueued but not yet dequeued
         ~Concurrent_Queue() {
             if constexpr (!std::is_trivially_destructible_v<T>) {
                 const std::size_t consumer_ticket = _head.value.load(std::memory_order_relaxed);
                 const std::size_t producer_ticket = _tail.value.load(std::memory_order_relaxed);
-                for (std::size_t ticket = consumer_ticket; ticket < producer_ticket; ++p) {
+                for (std::size_t ticket = consumer_ticket; ticket < producer_ticket; ++ticket) {
                     auto& slot = _slots[ticket & _MASK];
                     if (slot._expected_ticket.load(std::memory_order_relaxed) == ticket + 1) {
                         slot.to_ptr()->~T();
@@ -318,12 +330,14 @@ namespace BA_Concurrency {
 
             // Step 3
             ::new (slot.to_ptr()) T(std::move(data));
+            if (_monitor) stamp(slot);
 
             // Step 4
             slot._expected_ticket.store(producer_ticket + 1, std::memory_order_release);
 
             // increment the size
             ++_size;
+            if (_monitor) report(_head.value.load(std::memory_order_relaxed), producer_ticket + 1);
         }
 
         // Blocking dequeue: busy-wait while EMPTY at reservation time.
@@ -373,6 +387,7 @@ namespace BA_Concurrency {
 
             // decrement the size
             --_size;
+            if (_monitor) report(consumer_ticket + 1, _tail.value.load(std::memory_order_relaxed));
 
             // Step 6
             return data;
@@ -413,7 +428,7 @@ namespace BA_Concurrency {
         template <class U>
         bool try_push(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
             // Step 1
-            const std::size_t producer_ticket = _tail.value.load(std::memory_order_acquire);
+            std::size_t producer_ticket = _tail.value.load(std::memory_order_acquire);
 
             // the infinite loop
             while (true) {
@@ -432,12 +447,14 @@ namespace BA_Concurrency {
 
                 // Step 4
                 ::new (slot.to_ptr()) T(std::forward<U>(data));
+                if (_monitor) stamp(slot);
 
                 // Step 5
                 slot._expected_ticket.store(producer_ticket + 1, std::memory_order_release);
 
                 // increment the size
                 ++_size;
+                if (_monitor) report(_head.value.load(std::memory_order_relaxed), producer_ticket + 1);
 
                 // Step 6
                 return true;
@@ -524,6 +541,7 @@ namespace BA_Concurrency {
 
                 // decrement the size
                 --_size;
+                if (_monitor) report(consumer_ticket + 1, _tail.value.load(std::memory_order_relaxed));
 
                 // Step 8
                 return data;
@@ -540,8 +558,37 @@ namespace BA_Concurrency {
 
         inline std::size_t capacity() const noexcept { return _CAPACITY; }
 
+        // the depth from the tickets without touching the contended _size counter.
+        // clamped to [0, _CAPACITY] as the tickets of the waiting threads run ahead.
+        inline std::size_t approximate_size() const noexcept override {
+            const std::size_t consumer_ticket = _head.value.load(std::memory_order_relaxed);
+            const std::size_t producer_ticket = _tail.value.load(std::memory_order_relaxed);
+            return Queue_Monitor::depth(consumer_ticket, producer_ticket, _CAPACITY);
+        }
+
+        // the age of the front item from the push timestamp of its slot.
+        // zero if the queue is not monitored or the front slot is not published yet.
+        inline std::chrono::nanoseconds oldest_item_age() const noexcept override {
+            if (!_monitor) return std::chrono::nanoseconds::zero();
+            const std::size_t consumer_ticket = _head.value.load(std::memory_order_acquire);
+            const Slot& slot = _slots[consumer_ticket & _MASK];
+            if (slot._expected_ticket.load(std::memory_order_acquire) != consumer_ticket + 1)
+                return std::chrono::nanoseconds::zero();
+            return Queue_Monitor::age(slot._push_time.load(std::memory_order_relaxed));
+        }
+
     private:
 
+        // store the push timestamp (published by the release of the expected ticket)
+        static void stamp(Slot& slot) noexcept {
+            slot._push_time.store(Queue_Monitor::now(), std::memory_order_relaxed);
+        }
+
+        // report the approximate depth to the monitor
+        void report(std::size_t consumer_ticket, std::size_t producer_ticket) noexcept {
+            _monitor->observe(Queue_Monitor::depth(consumer_ticket, producer_ticket, _CAPACITY));
+        }
+
         // MEMBERS:
         // The monotonic (only incrementation is allowed) tickets: _head and _tail.
         // The tickets simulates the _head and _tail pointers of the queue data structure.
@@ -571,6 +618,7 @@ namespace BA_Concurrency {
         _CLWA _tail{0}; // next ticket to push
         Slot _slots[_CAPACITY];
         std::atomic<size_t> _size{0};
+        Queue_Monitor* _monitor{}; // set by the constructor only
     };
 
     template <
@@ -0,0 +1,592 @@
+// Concurrent_Queue__WF_Ring_MPMC.hpp
+//
+// Description:
+//   The wait-free solution for the bounded ring/MPMC queue problem (e.g. the hard real-time paths):
+//     The ticket ring of Concurrent_Queue__LF_Ring_MPMC.hpp reserves a slot by fetch_add
+//     and spins on the reserved slot.
+//     Hence, a descheduled thread stalls the threads reserving the same slot
+//     and an operation has no bound on its steps.
+//     This queue bounds the steps of every operation
+//     by the fast-path/slow-path methodology (Kogan and Petrank):
+//       fast path: a lock-free attempt repeated at most Patience times
+//       slow path: the operation is announced with a phase number
+//                  and is completed by the helping threads
+//     All steps of an operation can be completed by any thread.
+//     Hence, no thread waits for a descheduled thread.
+//
+//   The data is stored in a static array of _CAPACITY slots
+//   and the queue moves the slot indices between two index rings:
+//     _free: the indices of the free slots (initially all indices)
+//     _full: the indices of the slots holding data in the FIFO order
+//   push: pop an index from _free, construct the data into the slot, push the index to _full
+//   pop : pop an index from _full, move the data out of the slot, push the index to _free
+//   The index rings hold at most _CAPACITY indices.
+//   Hence, an index ring is never full and only the emptiness is reported.
+//
+// Requirements:
+// - T must be noexcept-constructible.
+// - T must be noexcept-movable.
+// - Capacity_As_Pow2 <= 16 (the indices are packed into 16 bits).
+// - At most pow2_size<Thread_Count_As_Pow2> threads may use the queues of the same type at a time.
+//
+// Design (Index_Ring):
+//   Cell:
+//     _value    : {lap (the ticket of the cell), enqueuer tid, index}
+//                 the cell is filled for the ticket t iff lap == t
+//     _deq_owner: {lap, dequeuer tid} the tag of the dequeuer owning the cell for the lap
+//   _head and _tail: the monotonic tickets
+//   _states: the operation descriptors of the threads (one word per thread):
+//     {phase, pending, enqueue, payload}
+//     payload: the index to be enqueued (enqueue),
+//              the targeted head ticket while pending or the result (dequeue)
+//
+// Semantics (Index_Ring):
+//   enqueue (the steps are shared by the fast path and the helpers):
+//     1. If the cell at the _tail is filled, finish the enqueue at the _tail (advance the _tail)
+//     2. Otherwise fill the cell at the _tail by CAS({lap: tail - capacity}, {lap: tail, tid, index})
+//     3. Finish the enqueue: complete the descriptor of the tid (if slow) and advance the _tail
+//   dequeue (the steps are shared by the fast path and the helpers):
+//     1. If _head == _tail, return EMPTY (or finish the lagging enqueue at the _tail)
+//     2. Record the targeted head ticket in the descriptor (slow path only)
+//     3. Tag the cell at the _head by CAS on _deq_owner
+//     4. Finish the dequeue: complete the descriptor of the tag owner (if slow) and advance the _head
+//   slow path:
+//     1. Take a phase number from the shared phase counter
+//     2. Announce the descriptor
+//     3. Help all pending descriptors with a phase not greater than this phase (including this one)
+//     4. Finish the operation (advance the _tail or the _head past the cell of the descriptor)
+//   helping on the fast path:
+//     Before each operation, a thread inspects the descriptor of the next peer (round-robin)
+//     and helps it if pending.
+//
+// Progress:
+//   Wait-free:
+//     The fast path is bounded by Patience.
+//     A pending descriptor is helped by all threads starting new operations (round-robin)
+//     and by all slow path operations with greater phases.
+//     Hence, an announced operation completes in a bounded number of steps
+//     (proportional to the number of the threads).
+//
+// Notes:
+//   1. The helping protocol relies on the single total order of the operations
+//      on the tickets, the cells and the descriptors.
+//      Hence, the operations are sequentially consistent.
+//      On x86 the loads are plain loads and the RMW operations are locked anyway.
+//   2. The ABA problem is solved by the laps of the cells and the monotonic tickets:
+//      a stale CAS expects the word of an older lap.
+//   3. A filled cell is tagged once per lap (CAS on _deq_owner)
+//      and a descriptor is completed once (CAS from pending).
+//      The descriptor is completed before the _head is advanced (help_finish_dequeue)
+//      and the tag identifies the tid but not the phase.
+//      Hence, the slow path finishes its cell (advances the _head) before returning:
+//      otherwise the next descriptor of the tid could target the same head
+//      and be completed by the stale tag (the same index dequeued twice).
+//      The enqueue does the same for the _tail.
+//      Hence, an index is enqueued and dequeued exactly once.
+//   4. The cells and the descriptors are single words in static arrays.
+//      Hence, no memory reclamation is required.
+//   5. The fast path costs a few loads and two CAS operations per index ring
+//      in addition to the inspection of a peer descriptor.
+//
+// Cautions:
+//   1. The thread ids are allocated per queue type by a Bitmap_Allocator
+//      and released at the thread exit.
+//      Exceeding the maximum thread count terminates (see Hazard_Ptr.hpp for the same policy).
+//   2. The phase numbers and the laps are truncated (30 and 32 bits).
+//      A thread must be stalled for 2^29 slow operations (phases) or 2^32 operations (laps)
+//      to break the comparisons.
+//   3. push is blocking when the queue is FULL (the waiting is for a pop, not for a stalled thread).
+//      Use try_push for the bounded steps.
+//   4. Use queue_WF_ring_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Queue
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider the wCQ design (Nikolaev and Ravindran) which avoids the index rings
+//      at the expense of a double-width CAS.
+
+#ifndef CONCURRENT_QUEUE_WF_RING_MPMC_HPP
+#define CONCURRENT_QUEUE_WF_RING_MPMC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+#include "Bitmap_Allocator.hpp"
+
+namespace BA_Concurrency {
+    // the specialization key of the wait-free mode of the ring MPMC queue
+    struct Wait_Free {};
+
+    inline constexpr std::size_t WAIT_FREE_PATIENCE__DEFAULT = 16;
+
+    // use queue_WF_ring_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Queue
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2,
+        std::size_t Patience,
+        unsigned char Thread_Count_As_Pow2>
+    requires (
+            Capacity_As_Pow2 <= 16 &&
+            Thread_Count_As_Pow2 >= 6 &&
+            Thread_Count_As_Pow2 < 16 &&
+            std::is_nothrow_constructible_v<T> &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>,
+        Wait_Free,
+        std::integral_constant<std::size_t, Patience>,
+        std::integral_constant<unsigned char, Thread_Count_As_Pow2>>
+        : public IConcurrent_Queue<T>
+    {
+        static constexpr std::size_t _CAPACITY     = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::size_t _THREAD_COUNT = pow2_size<Thread_Count_As_Pow2>;
+
+        // the wait-free ring of the slot indices.
+        // holds at most _CAPACITY indices and hence is never full.
+        class Index_Ring {
+            static constexpr std::uint32_t _EMPTY = UINT32_MAX; // the dequeue result for the empty ring
+            static constexpr std::uint16_t _FAST  = UINT16_MAX; // the tid of the fast path operations
+            static constexpr std::uint32_t _PHASE_MASK = (std::uint32_t{1} << 30) - 1;
+            static constexpr auto _SC = std::memory_order_seq_cst;
+
+            struct Cell {
+                std::atomic<std::uint64_t> _value;
+                std::atomic<std::uint64_t> _deq_owner;
+            };
+
+            // the cell words: {lap: 32 bits, tid: 16 bits, index: 16 bits}
+            static constexpr std::uint64_t make_value(std::size_t ticket, std::uint16_t tid, std::uint32_t index) noexcept {
+                return std::uint64_t{static_cast<std::uint32_t>(ticket)} << 32 | std::uint64_t{tid} << 16 | index;
+            }
+            static constexpr std::uint32_t lap(std::uint64_t word) noexcept { return static_cast<std::uint32_t>(word >> 32); }
+            static constexpr std::uint16_t tid(std::uint64_t word) noexcept { return static_cast<std::uint16_t>(word >> 16); }
+            static constexpr std::uint32_t index(std::uint64_t word) noexcept { return static_cast<std::uint16_t>(word); }
+
+            // the descriptor words: {phase: 30 bits, pending: 1 bit, enqueue: 1 bit, payload: 32 bits}
+            static constexpr std::uint64_t make_state(
+                std::uint32_t phase,
+                bool pending,
+                bool enqueue,
+                std::uint32_t payload) noexcept
+            {
+                return
+                    std::uint64_t{phase & _PHASE_MASK} << 34 |
+                    std::uint64_t{pending} << 33 |
+                    std::uint64_t{enqueue} << 32 |
+                    payload;
+            }
+            static constexpr std::uint32_t phase(std::uint64_t state) noexcept { return static_cast<std::uint32_t>(state >> 34); }
+            static constexpr bool is_pending(std::uint64_t state) noexcept { return (state >> 33) & 1; }
+            static constexpr bool is_enqueue(std::uint64_t state) noexcept { return (state >> 32) & 1; }
+            static constexpr std::uint32_t payload(std::uint64_t state) noexcept { return static_cast<std::uint32_t>(state); }
+
+            // the serial number comparison of the truncated phases
+            static constexpr bool is_not_after(std::uint32_t lhs, std::uint32_t rhs) noexcept {
+                return ((rhs - lhs) & _PHASE_MASK) < (_PHASE_MASK >> 1);
+            }
+
+            bool is_still_pending(std::uint16_t tid, std::uint32_t phase_) const noexcept {
+                const std::uint64_t state = _states[tid].value.load(_SC);
+                return is_pending(state) && is_not_after(phase(state), phase_);
+            }
+
+            // Step 3 of enqueue: complete the descriptor (if slow) and advance the _tail
+            void help_finish_enqueue() noexcept {
+                std::size_t tail = _tail.value.load(_SC);
+                const std::uint64_t value = _cells[tail % _CAPACITY]._value.load(_SC);
+                if (lap(value) != static_cast<std::uint32_t>(tail)) return;
+                if (const std::uint16_t tid_ = tid(value); tid_ != _FAST) {
+                    std::uint64_t state = _states[tid_].value.load(_SC);
+                    if (
+                        tail == _tail.value.load(_SC) &&
+                        is_pending(state) &&
+                        is_enqueue(state) &&
+                        payload(state) == index(value))
+                        _states[tid_].value.compare_exchange_strong(
+                            state,
+                            make_state(phase(state), false, true, index(value)),
+                            _SC);
+                }
+                _tail.value.compare_exchange_strong(tail, tail + 1, _SC);
+            }
+
+            // Step 4 of dequeue: complete the descriptor of the tag owner (if slow) and advance the _head
+            void help_finish_dequeue() noexcept {
+                std::size_t head = _head.value.load(_SC);
+                Cell& cell = _cells[head % _CAPACITY];
+                const std::uint64_t owner = cell._deq_owner.load(_SC);
+                if (lap(owner) != static_cast<std::uint32_t>(head)) return;
+                if (const std::uint16_t tid_ = tid(owner); tid_ != _FAST) {
+                    std::uint64_t state = _states[tid_].value.load(_SC);
+                    const std::uint64_t value = cell._value.load(_SC);
+                    if (
+                        head == _head.value.load(_SC) &&
+                        lap(value) == static_cast<std::uint32_t>(head) &&
+                        is_pending(state) &&
+                        !is_enqueue(state) &&
+                        payload(state) == static_cast<std::uint32_t>(head))
+                        _states[tid_].value.compare_exchange_strong(
+                            state,
+                            make_state(phase(state), false, false, index(value)),
+                            _SC);
+                }
+                _head.value.compare_exchange_strong(head, head + 1, _SC);
+            }
+
+            // a single enqueue trial at the current _tail
+            // for the fast path (tid == _FAST) or for the descriptor of the tid (state).
+            // returns true if the index is placed by this trial
+            bool try_enqueue_once(std::uint16_t tid_, std::uint32_t index_, std::uint64_t state = 0) noexcept {
+                const std::size_t tail = _tail.value.load(_SC);
+                Cell& cell = _cells[tail % _CAPACITY];
+                std::uint64_t value = cell._value.load(_SC);
+                if (tail != _tail.value.load(_SC)) return false;
+
+                // Step 1
+                if (lap(value) == static_cast<std::uint32_t>(tail)) {
+                    help_finish_enqueue();
+                    return false;
+                }
+
+                // the previous lap of the cell is tagged but the _head is lagging
+                if (_head.value.load(_SC) + _CAPACITY <= tail) {
+                    help_finish_dequeue();
+                    return false;
+                }
+                if (lap(value) != static_cast<std::uint32_t>(tail - _CAPACITY)) return false;
+
+                // the helpers place the index only while the descriptor is pending:
+                // a pending descriptor is not placed at a ticket before the _tail
+                // as the _tail is advanced after the descriptor is completed
+                if (tid_ != _FAST && _states[tid_].value.load(_SC) != state) return false;
+
+                // Step 2
+                if (!cell._value.compare_exchange_strong(value, make_value(tail, tid_, index_), _SC))
+                    return false;
+
+                // Step 3
+                help_finish_enqueue();
+                return true;
+            }
+
+            // the slow path of enqueue: help until the descriptor of the tid is completed
+            void help_enqueue(std::uint16_t tid_, std::uint32_t phase_) noexcept {
+                while (is_still_pending(tid_, phase_)) {
+                    const std::uint64_t state = _states[tid_].value.load(_SC);
+                    if (phase(state) != (phase_ & _PHASE_MASK) || !is_pending(state)) return;
+                    try_enqueue_once(tid_, payload(state), state);
+                }
+            }
+
+            // the slow path of dequeue: help until the descriptor of the tid is completed
+            void help_dequeue(std::uint16_t tid_, std::uint32_t phase_) noexcept {
+                while (is_still_pending(tid_, phase_)) {
+                    const std::size_t head = _head.value.load(_SC);
+                    const std::size_t tail = _tail.value.load(_SC);
+                    if (head != _head.value.load(_SC)) continue;
+
+                    // Step 1
+                    if (head == tail) {
+                        const std::uint64_t value = _cells[tail % _CAPACITY]._value.load(_SC);
+                        if (lap(value) == static_cast<std::uint32_t>(tail)) {
+                            help_finish_enqueue();
+                            continue;
+                        }
+                        std::uint64_t state = _states[tid_].value.load(_SC);
+                        if (
+                            tail == _tail.value.load(_SC) &&
+                            is_pending(state) &&
+                            phase(state) == (phase_ & _PHASE_MASK))
+                            _states[tid_].value.compare_exchange_strong(
+                                state,
+                                make_state(phase(state), false, false, _EMPTY),
+                                _SC);
+                        continue;
+                    }
+
+                    // Step 2
+                    std::uint64_t state = _states[tid_].value.load(_SC);
+                    if (!is_pending(state) || phase(state) != (phase_ & _PHASE_MASK)) return;
+                    if (
+                        head == _head.value.load(_SC) &&
+                        payload(state) != static_cast<std::uint32_t>(head) &&
+                        !_states[tid_].value.compare_exchange_strong(
+                            state,
+                            make_state(phase(state), true, false, static_cast<std::uint32_t>(head)),
+                            _SC))
+                        continue;
+
+                    // Step 3
+                    Cell& cell = _cells[head % _CAPACITY];
+                    std::uint64_t owner = cell._deq_owner.load(_SC);
+                    if (lap(owner) != static_cast<std::uint32_t>(head) && head == _head.value.load(_SC))
+                        cell._deq_owner.compare_exchange_strong(owner, make_value(head, tid_, 0), _SC);
+
+                    // Step 4
+                    help_finish_dequeue();
+                }
+            }
+
+            // help all pending descriptors with a phase not greater than the phase
+            void help(std::uint32_t phase_) noexcept {
+                for (std::uint16_t tid_ = 0; tid_ < _THREAD_COUNT; ++tid_) {
+                    const std::uint64_t state = _states[tid_].value.load(_SC);
+                    if (!is_pending(state) || !is_not_after(phase(state), phase_)) continue;
+                    if (is_enqueue(state)) help_enqueue(tid_, phase(state));
+                    else help_dequeue(tid_, phase(state));
+                }
+            }
+
+            // helping on the fast path: inspect the next peer (round-robin)
+            void help_peer(std::uint16_t tid_) noexcept {
+                static thread_local std::uint16_t peer{};
+                peer = static_cast<std::uint16_t>((peer + 1) % _THREAD_COUNT);
+                if (peer == tid_) return;
+                const std::uint64_t state = _states[peer].value.load(_SC);
+                if (!is_pending(state)) return;
+                if (is_enqueue(state)) help_enqueue(peer, phase(state));
+                else help_dequeue(peer, phase(state));
+            }
+
+            // announce the descriptor and help until completed
+            std::uint64_t slow_path(std::uint16_t tid_, bool enqueue, std::uint32_t payload_) noexcept {
+                const std::uint32_t phase_ = _phase.value.fetch_add(1, _SC) & _PHASE_MASK;
+                _states[tid_].value.store(make_state(phase_, true, enqueue, payload_), _SC);
+                help(phase_);
+                return _states[tid_].value.load(_SC);
+            }
+
+        public:
+
+            // fill: the ring is initialized with all indices
+            explicit Index_Ring(bool fill) noexcept {
+                for (std::size_t i = 0; i < _CAPACITY; ++i) {
+                    _cells[i]._value.store(
+                        fill ?
+                        make_value(i, _FAST, static_cast<std::uint32_t>(i)) :
+                        make_value(i - _CAPACITY, _FAST, 0),
+                        std::memory_order_relaxed);
+                    _cells[i]._deq_owner.store(make_value(i - _CAPACITY, _FAST, 0), std::memory_order_relaxed);
+                }
+                _tail.value.store(fill ? _CAPACITY : 0, std::memory_order_relaxed);
+            }
+
+            void enqueue(std::uint16_t tid_, std::uint32_t index_) noexcept {
+                help_peer(tid_);
+
+                // the fast path
+                for (std::size_t trial = 0; trial < Patience; ++trial)
+                    if (try_enqueue_once(_FAST, index_)) return;
+
+                // the slow path
+                slow_path(tid_, true, index_);
+                // Step 3: see Notes 3
+                help_finish_enqueue();
+            }
+
+            // returns std::nullopt if the ring is empty
+            std::optional<std::uint32_t> dequeue(std::uint16_t tid_) noexcept {
+                help_peer(tid_);
+
+                // the fast path
+                for (std::size_t trial = 0; trial < Patience; ++trial) {
+                    const std::size_t head = _head.value.load(_SC);
+                    const std::size_t tail = _tail.value.load(_SC);
+                    if (head != _head.value.load(_SC)) continue;
+
+                    // Step 1
+                    if (head == tail) {
+                        const std::uint64_t value = _cells[tail % _CAPACITY]._value.load(_SC);
+                        if (lap(value) != static_cast<std::uint32_t>(tail)) return std::nullopt;
+                        help_finish_enqueue();
+                        continue;
+                    }
+
+                    // Step 3: the value of the lap is stable until the tagged cell is finished
+                    Cell& cell = _cells[head % _CAPACITY];
+                    const std::uint64_t value = cell._value.load(_SC);
+                    std::uint64_t owner = cell._deq_owner.load(_SC);
+                    if (lap(value) != static_cast<std::uint32_t>(head)) continue;
+                    if (
+                        lap(owner) == static_cast<std::uint32_t>(head) ||
+                        !cell._deq_owner.compare_exchange_strong(owner, make_value(head, _FAST, 0), _SC))
+                    {
+                        help_finish_dequeue();
+                        continue;
+                    }
+
+                    // Step 4
+                    help_finish_dequeue();
+                    return index(value);
+                }
+
+                // the slow path
+                const std::uint32_t result = payload(slow_path(tid_, false, _EMPTY));
+                // Step 4: see Notes 3
+                help_finish_dequeue();
+                if (result == _EMPTY) return std::nullopt;
+                return result;
+            }
+
+            std::size_t size() const noexcept {
+                const std::size_t head = _head.value.load(std::memory_order_acquire);
+                const std::size_t tail = _tail.value.load(std::memory_order_acquire);
+                return tail > head ? tail - head : 0;
+            }
+
+        private:
+
+            // MEMBERS:
+            cache_line_wrapper<std::atomic<std::size_t>> _head{ 0 };
+            cache_line_wrapper<std::atomic<std::size_t>> _tail{ 0 };
+            cache_line_wrapper<std::atomic<std::uint32_t>> _phase{ 0 };
+            cache_line_wrapper<std::atomic<std::uint64_t>> _states[_THREAD_COUNT]{};
+            Cell _cells[_CAPACITY];
+        };
+
+        struct Slot {
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        // the thread id shared by the queues of this type.
+        // released at the thread exit (see Caution 1 in the header documentation).
+        static std::uint16_t thread_id() noexcept {
+            static Bitmap_Allocator<Thread_Count_As_Pow2> thread_ids;
+            struct Thread_Id {
+                std::size_t _id;
+                Thread_Id() noexcept {
+                    auto id = thread_ids.allocate();
+                    if (!id.has_value()) std::terminate();
+                    _id = *id;
+                }
+                ~Thread_Id() { thread_ids.deallocate(_id); }
+            };
+            static thread_local Thread_Id thread_id_;
+            return static_cast<std::uint16_t>(thread_id_._id);
+        }
+
+    public:
+
+        Concurrent_Queue() noexcept = default;
+
+        // Single-threaded context expected.
+        // destroy the elements that were pushed but not yet popped
+        ~Concurrent_Queue() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                const std::uint16_t tid = thread_id();
+                while (auto index = _full.dequeue(tid)) _slots[*index].to_ptr()->~T();
+            }
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        // Blocking enqueue: yields while FULL (see Caution 3 in the header documentation).
+        void push(T data) noexcept(std::is_nothrow_constructible_v<T>) override {
+            while (!try_push(std::move(data))) std::this_thread::yield();
+        }
+
+        // Wait-free enqueue: Returns false if FULL.
+        //   1. Pop a free slot index
+        //   2. Construct the data into the slot
+        //   3. Push the index to the full ring
+        template <class U>
+        bool try_push(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            const std::uint16_t tid = thread_id();
+
+            // Step 1
+            const auto index = _free.dequeue(tid);
+            if (!index.has_value()) return false;
+
+            // Step 2
+            ::new (_slots[*index].to_ptr()) T(std::forward<U>(data));
+
+            // Step 3
+            _full.enqueue(tid, *index);
+            return true;
+        }
+
+        // Blocking dequeue: yields while EMPTY.
+        std::optional<T> pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            while (true) {
+                if (auto data = try_pop(); data.has_value()) return data;
+                std::this_thread::yield();
+            }
+        }
+
+        // Wait-free dequeue: Returns nullopt if EMPTY.
+        //   1. Pop a full slot index
+        //   2. Move the data out of the slot and destroy the object
+        //   3. Push the index to the free ring
+        std::optional<T> try_pop() noexcept(std::is_nothrow_move_constructible_v<T>) override {
+            const std::uint16_t tid = thread_id();
+
+            // Step 1
+            const auto index = _full.dequeue(tid);
+            if (!index.has_value()) return std::nullopt;
+
+            // Step 2
+            T* ptr = _slots[*index].to_ptr();
+            std::optional<T> data{ std::move(*ptr) };
+            if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+
+            // Step 3
+            _free.enqueue(tid, *index);
+            return data;
+        }
+
+        inline size_t size() const noexcept override {
+            return _full.size();
+        }
+
+        inline bool empty() const noexcept override {
+            return _full.size() == 0;
+        }
+
+        inline std::size_t capacity() const noexcept { return _CAPACITY; }
+
+    private:
+
+        // MEMBERS:
+        Index_Ring _free{ true };
+        Index_Ring _full{ false };
+        Slot _slots[_CAPACITY];
+    };
+
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2,
+        std::size_t Patience = WAIT_FREE_PATIENCE__DEFAULT,
+        unsigned char Thread_Count_As_Pow2 = 6>
+    using queue_WF_ring_MPMC = Concurrent_Queue<
+        true,
+        Enum_Structure_Types::Static_Ring_Buffer,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>,
+        Wait_Free,
+        std::integral_constant<std::size_t, Patience>,
+        std::integral_constant<unsigned char, Thread_Count_As_Pow2>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_QUEUE_WF_RING_MPMC_HPP
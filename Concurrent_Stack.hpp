@@ -5,6 +5,7 @@
 //   - some additional case dependent arguments
 //     Ex: Enum_Structure_Types::Linked requires a memory reclaimer pattern
 //         such as the hazard pointers
+//     Ex: Enum_Structure_Types::Static_Array requires the capacity
 #ifndef CONCURRENT_STACK_HPP
 #define CONCURRENT_STACK_HPP
 
@@ -0,0 +1,113 @@
+// Concurrent_Stack__Flat_Combining.hpp
+//
+// Description:
+//   The flat-combining version of the stack:
+//     A sequential stack (std::vector) wrapped by Flat_Combiner.
+//     The threads publish push and pop operations
+//     and the combiner thread applies them in a batch.
+//     Provided for the comparison with the lock-free linked stacks:
+//       Concurrent_Stack__LF_Linked_MPSC.hpp
+//       Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp
+//
+// Requirements:
+// - T must be noexcept-movable.
+//
+// Semantics:
+//   push():
+//     Publish the operation: stack.push_back(data)
+//   pop():
+//     Publish the operation:
+//       IF the stack is empty return std::nullopt
+//       Move the data out from the back and pop_back
+//
+//   See the documentation of Flat_Combiner.hpp for the details about the flat-combining.
+//
+// Progress:
+//   Blocking:
+//     See the documentation of Flat_Combiner.hpp.
+//
+// Notes:
+//   1. The contiguous buffer of std::vector requires no memory reclamation
+//      as the nodes are not shared between the threads.
+//      Hence, the memory reclaimers (e.g. hazard pointers) are not required.
+//
+// Cautions:
+//   1. Use stack_FC_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Stack
+//      and to achieve the default arguments consistently.
+//   2. std::vector::push_back may throw std::bad_alloc inside the combiner.
+//      See the requirements of Flat_Combiner.hpp.
+
+#ifndef CONCURRENT_STACK_FLAT_COMBINING_HPP
+#define CONCURRENT_STACK_FLAT_COMBINING_HPP
+
+#include <cstddef>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <type_traits>
+#include "Concurrent_Stack.hpp"
+#include "Flat_Combiner.hpp"
+
+namespace BA_Concurrency {
+    // use stack_FC_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Stack
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        std::size_t Publication_Slot_Count>
+    requires ( // for the thread safety of pop as it returns std::optional<T>
+            std::is_nothrow_move_constructible_v<T> &&
+            std::is_nothrow_move_assignable_v<T>)
+    class Concurrent_Stack<
+        false,
+        Enum_Structure_Types::Dynamic_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Flat_Combiner<std::vector<T>, Publication_Slot_Count>>
+    {
+        Flat_Combiner<std::vector<T>, Publication_Slot_Count> _stack;
+
+    public:
+
+        Concurrent_Stack() = default;
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Stack(const Concurrent_Stack&) = delete;
+        Concurrent_Stack& operator=(const Concurrent_Stack&) = delete;
+        Concurrent_Stack(Concurrent_Stack&&) = delete;
+        Concurrent_Stack& operator=(Concurrent_Stack&&) = delete;
+
+        template <typename U = T>
+        void push(U&& data) {
+            _stack.apply([&data](std::vector<T>& stack) {
+                stack.push_back(std::forward<U>(data));
+            });
+        }
+
+        std::optional<T> pop() {
+            return _stack.apply([](std::vector<T>& stack) -> std::optional<T> {
+                if (stack.empty()) return std::nullopt;
+                std::optional<T> data{ std::move(stack.back()) };
+                stack.pop_back();
+                return data;
+            });
+        }
+
+        bool empty() {
+            return _stack.apply([](std::vector<T>& stack) { return stack.empty(); });
+        }
+    };
+
+    template <
+        typename T,
+        std::size_t Publication_Slot_Count = FLAT_COMBINING_SLOT_COUNT__DEFAULT>
+    using stack_FC_MPMC = Concurrent_Stack<
+        false,
+        Enum_Structure_Types::Dynamic_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Flat_Combiner<std::vector<T>, Publication_Slot_Count>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_STACK_FLAT_COMBINING_HPP
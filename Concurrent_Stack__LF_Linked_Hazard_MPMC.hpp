@@ -27,6 +27,31 @@
 //       4. Clear the hazard pointer
 //       5. Add the old head to the reclaim list
 //       6. Return the data
+//   push_range():
+//     The bulk push with a single CAS:
+//       1. Create the nodes and link them locally into a chain
+//          (the last element of the range becomes the top)
+//          If the creation of a node throws, the chain is deleted and the exception is rethrown.
+//       2. Set the next pointer of the chain tail to the current head.
+//       3. Apply CAS on the head: CAS(chain_tail->head, chain_head)
+//   pop_all():
+//     The bulk pop with a single atomic exchange:
+//       1. Exchange the head with nullptr (the whole list is detached)
+//       2. Reserve the result and the reclaim list for the detached nodes
+//          If the reservation throws, the detached list is pushed back and the exception is rethrown.
+//       3. Move the data out from the detached nodes in the LIFO order
+//       4. Add the detached nodes to the reclaim list
+//       5. Return the data
+//     The detachment is atomic and requires no hazard pointer.
+//     However, the detached nodes may still be protected by the hazard ptrs of
+//     the concurrent pop calls which have not reached their CAS yet.
+//     Hence, the detached nodes are reclaimed through the hazard ptrs as well.
+//     Steps 3 and 4 do not throw (T is noexcept-movable and the containers are reserved).
+//     Pushing the detached list back rewrites the next pointer of the detached tail.
+//     A pop which protected the tail before the detachment may hold its old next pointer
+//     and would succeed its CAS when the tail becomes the head again (ABA).
+//     Hence, the push back waits until the tail is not protected by any hazard ptr
+//     (such a pop fails its CAS as the head has changed and moves its hazard ptr).
 //
 //   See the documentation of Hazard_Ptr.hpp for the details about the hazard pointers.
 //
@@ -88,6 +113,7 @@
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <iterator>
 #include "Node.hpp"
 #include "Concurrent_Stack.hpp"
 #include "enum_memory_reclaimers.hpp"
@@ -122,6 +148,41 @@ namespace BA_Concurrency {
         allocator_type _allocator;
         std::atomic<Node<T>*> _head{ nullptr };
 
+        // allocate and construct a node (the memory is released if the construction throws)
+        template <typename U>
+        Node<T>* create_node(U&& data) {
+            Node<T>* node = traits::allocate(_allocator, 1);
+            try {
+                traits::construct(_allocator, node, std::forward<U>(data));
+            }
+            catch (...) {
+                traits::deallocate(_allocator, node, 1);
+                throw;
+            }
+            return node;
+        }
+
+        // delete a chain which has never been published (or a chain of the destructor)
+        void delete_chain(Node<T>* node) noexcept {
+            while (node) {
+                Node<T>* next = node->_next;
+                traits::destroy(_allocator, node);
+                traits::deallocate(_allocator, node, 1);
+                node = next;
+            }
+        }
+
+        // Steps 2 and 3 of push_range: push the chain with a single CAS
+        void push_chain(Node<T>* chain_head, Node<T>* chain_tail) noexcept {
+            chain_tail->_next = _head.load(std::memory_order_relaxed); // CAS loop will correct the next pointer
+            while (
+                !_head.compare_exchange_weak(
+                    chain_tail->_next,
+                    chain_head,
+                    std::memory_order_release,
+                    std::memory_order_relaxed));
+        }
+
     public:
 
         Concurrent_Stack() = default;
@@ -130,13 +191,7 @@ namespace BA_Concurrency {
 
         ~Concurrent_Stack() {
             // delete the not-yet-reclaimed nodes if exists any
-            Node<T>* old_head = _head.load(std::memory_order_relaxed);
-            while (old_head) {
-                Node<T>* next = old_head->_next;
-                traits::destroy(_allocator, old_head);
-                traits::deallocate(_allocator, old_head, 1);
-                old_head = next;
-            }
+            delete_chain(_head.load(std::memory_order_relaxed));
 
             // reclaim the defered reclaimers
             // TODO:
@@ -167,9 +222,8 @@ namespace BA_Concurrency {
         //   3. Apply CAS on the head: CAS(new_node->head, new_node)
         template <typename U = T>
         void push(U&& data) {
-            Node<T>* new_head = traits::allocate(_allocator, 1);
+            Node<T>* new_head = create_node(std::forward<U>(data));
             new_head->_next = _head.load(std::memory_order_relaxed); // CAS loop will correct the next pointer
-            new_head->_data = std::forward<U>(data);
             while (
                 !_head.compare_exchange_weak(
                     new_head->_next,
@@ -178,6 +232,35 @@ namespace BA_Concurrency {
                     std::memory_order_relaxed));
         }
 
+        // bulk push function with a single CAS:
+        //   1. Create the nodes and link them locally into a chain
+        //      (the last element of the range becomes the top)
+        //   2. Set the next pointer of the chain tail to the current head.
+        //   3. Apply CAS on the head: CAS(chain_tail->head, chain_head)
+        // the stack is unchanged if the creation of a node throws
+        template <std::input_iterator It, std::sentinel_for<It> S>
+        void push_range(It first, S last) {
+            if (first == last) return;
+
+            // Step 1
+            Node<T>* chain_tail = create_node(*first);
+            Node<T>* chain_head = chain_tail;
+            try {
+                for (++first; first != last; ++first) {
+                    Node<T>* node = create_node(*first);
+                    node->_next = chain_head;
+                    chain_head = node;
+                }
+            }
+            catch (...) {
+                delete_chain(chain_head);
+                throw;
+            }
+
+            // Steps 2 and 3
+            push_chain(chain_head, chain_tail);
+        }
+
         // pop function:
         //   1. Protect the head node by a hazard pointer
         //   2. Apply CAS on the head: CAS(head, head->next)
@@ -195,6 +278,8 @@ namespace BA_Concurrency {
                 do {
                     temp = old_head;
                     hazard_ptr_owner.protect(old_head); // protect by a hazard ptr
+                    // order the protection before the validation (see the push back of pop_all)
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
                     old_head = _head.load(std::memory_order_acquire);
                 } while(old_head != temp);
             } while(
@@ -222,6 +307,56 @@ namespace BA_Concurrency {
             return data;
         }
 
+        // bulk pop function with a single atomic exchange:
+        //   1. Exchange the head with nullptr (the whole list is detached)
+        //   2. Reserve the result and the reclaim list (push the detached list back if throws)
+        //   3. Move the data out from the detached nodes in the LIFO order
+        //   4. Add the detached nodes to the reclaim list
+        //   5. Return the data
+        //
+        // The detached nodes may still be protected by the concurrent pop calls.
+        // See the header documentation.
+        // the stack keeps the data if the reservation throws
+        std::vector<T> pop_all() {
+            // Step 1
+            Node<T>* old_head = _head.exchange(nullptr, std::memory_order_acq_rel);
+            if (!old_head) return {};
+
+            // Step 2
+            std::size_t count{ 1 };
+            Node<T>* old_tail = old_head;
+            for (; old_tail->_next; old_tail = old_tail->_next) ++count;
+            std::vector<T> data;
+            try {
+                data.reserve(count);
+                _HPO::reserve_reclaim_list(count);
+            }
+            catch (...) {
+                // wait for the pops holding the old next pointer of the tail (see the header documentation)
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                while (_HPO::is_protected(old_tail)) std::this_thread::yield();
+                push_chain(old_head, old_tail);
+                throw;
+            }
+
+            while (old_head) {
+                // Step 3
+                data.push_back(std::move(old_head->_data));
+
+                // Step 4: listed without an allocation (reserved).
+                // only the threshold reclamation may throw (before deleting any node): retried later
+                Node<T>* next = old_head->_next;
+                try {
+                    _HPO::reclaim_memory_later(static_cast<void*>(old_head), &_allocator, &delete_node);
+                }
+                catch (...) {}
+                old_head = next;
+            }
+
+            // Step 5
+            return data;
+        }
+
         bool empty() const noexcept {
             return _head.load(std::memory_order_acquire) == nullptr;
         }
@@ -22,6 +22,24 @@
 //       2. Move the data out from the old head node
 //       3. Delete the old head
 //       4. Return the data
+//   push_range():
+//     The bulk push with a single CAS:
+//       1. Create the nodes and link them locally into a chain
+//          (the last element of the range becomes the top)
+//          If the creation of a node throws, the chain is deleted and the exception is rethrown.
+//       2. Set the next pointer of the chain tail to the current head.
+//       3. Apply CAS on the head: CAS(chain_tail->head, chain_head)
+//   pop_all():
+//     The bulk pop with a single atomic exchange:
+//       1. Exchange the head with nullptr (the whole list is detached)
+//       2. Reserve the result for the detached nodes
+//          If the reservation throws, the detached list is pushed back (see push_range)
+//          and the exception is rethrown.
+//       3. Move the data out from the detached nodes in the LIFO order
+//       4. Delete the detached nodes
+//       5. Return the data
+//     The moves of Step 3 do not throw (T is noexcept-movable and the result is reserved).
+//     Pushing the detached list back is safe as the single consumer is the only reader of the next pointers.
 //
 // Progress:
 //   Lock-free:
@@ -63,6 +81,7 @@
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <iterator>
 #include "Node.hpp"
 #include "Concurrent_Stack.hpp"
 #include "enum_memory_reclaimers.hpp"
@@ -90,6 +109,40 @@ namespace BA_Concurrency {
         allocator_type _allocator;
         std::atomic<Node<T>*> _head{ nullptr };
 
+        // allocate and construct a node (the memory is released if the construction throws)
+        template <typename U>
+        Node<T>* create_node(U&& data) {
+            Node<T>* node = traits::allocate(_allocator, 1);
+            try {
+                traits::construct(_allocator, node, std::forward<U>(data));
+            }
+            catch (...) {
+                traits::deallocate(_allocator, node, 1);
+                throw;
+            }
+            return node;
+        }
+
+        void delete_chain(Node<T>* node) noexcept {
+            while (node) {
+                Node<T>* next = node->_next;
+                traits::destroy(_allocator, node);
+                traits::deallocate(_allocator, node, 1);
+                node = next;
+            }
+        }
+
+        // Steps 2 and 3 of push_range: push the chain with a single CAS
+        void push_chain(Node<T>* chain_head, Node<T>* chain_tail) noexcept {
+            chain_tail->_next = _head.load(std::memory_order_relaxed); // CAS loop will correct the next pointer
+            while (
+                !_head.compare_exchange_weak(
+                    chain_tail->_next,
+                    chain_head,
+                    std::memory_order_release,
+                    std::memory_order_relaxed));
+        }
+
     public:
 
         Concurrent_Stack() = default;
@@ -98,13 +151,7 @@ namespace BA_Concurrency {
 
         ~Concurrent_Stack() {
             // delete the not-yet-reclaimed nodes if exists any
-            Node<T>* old_head = _head.load(std::memory_order_relaxed);
-            while (old_head) {
-                Node<T>* next = old_head->_next;
-                traits::destroy(_allocator, old_head);
-                traits::deallocate(_allocator, old_head, 1);
-                old_head = next;
-            }
+            delete_chain(_head.load(std::memory_order_relaxed));
         }
 
         // Non-copyable/movable for simplicity
@@ -119,9 +166,8 @@ namespace BA_Concurrency {
         //   3. Apply CAS on the head: CAS(new_node->head, new_node)
         template <typename U = T>
         void push(U&& data) {
-            Node<T>* new_head = traits::allocate(_allocator, 1);
+            Node<T>* new_head = create_node(std::forward<U>(data));
             new_head->_next = _head.load(std::memory_order_relaxed); // CAS loop will correct the next pointer
-            new_head->_data = std::forward<U>(data);
             while (
                 !_head.compare_exchange_weak(
                     new_head->_next,
@@ -130,6 +176,35 @@ namespace BA_Concurrency {
                     std::memory_order_relaxed));
         }
 
+        // bulk push function with a single CAS:
+        //   1. Create the nodes and link them locally into a chain
+        //      (the last element of the range becomes the top)
+        //   2. Set the next pointer of the chain tail to the current head.
+        //   3. Apply CAS on the head: CAS(chain_tail->head, chain_head)
+        // the stack is unchanged if the creation of a node throws
+        template <std::input_iterator It, std::sentinel_for<It> S>
+        void push_range(It first, S last) {
+            if (first == last) return;
+
+            // Step 1
+            Node<T>* chain_tail = create_node(*first);
+            Node<T>* chain_head = chain_tail;
+            try {
+                for (++first; first != last; ++first) {
+                    Node<T>* node = create_node(*first);
+                    node->_next = chain_head;
+                    chain_head = node;
+                }
+            }
+            catch (...) {
+                delete_chain(chain_head);
+                throw;
+            }
+
+            // Steps 2 and 3
+            push_chain(chain_head, chain_tail);
+        }
+
         // pop function:
         //   1. Apply CAS on the head: CAS(head, head->next)
         //   2. Move the data out from the old head node
@@ -159,6 +234,46 @@ namespace BA_Concurrency {
             return data;
         }
 
+        // bulk pop function with a single atomic exchange:
+        //   1. Exchange the head with nullptr (the whole list is detached)
+        //   2. Reserve the result (push the detached list back if throws)
+        //   3. Move the data out from the detached nodes in the LIFO order
+        //   4. Delete the detached nodes
+        //   5. Return the data
+        // the stack keeps the data if the reservation throws
+        std::vector<T> pop_all() {
+            // Step 1
+            Node<T>* old_head = _head.exchange(nullptr, std::memory_order_acquire);
+            if (!old_head) return {};
+
+            // Step 2
+            std::size_t count{ 1 };
+            Node<T>* old_tail = old_head;
+            for (; old_tail->_next; old_tail = old_tail->_next) ++count;
+            std::vector<T> data;
+            try {
+                data.reserve(count);
+            }
+            catch (...) {
+                push_chain(old_head, old_tail);
+                throw;
+            }
+
+            while (old_head) {
+                // Step 3
+                data.push_back(std::move(old_head->_data));
+
+                // Step 4
+                Node<T>* next = old_head->_next;
+                traits::destroy(_allocator, old_head);
+                traits::deallocate(_allocator, old_head, 1);
+                old_head = next;
+            }
+
+            // Step 5
+            return data;
+        }
+
         bool empty() const noexcept {
             return _head.load(std::memory_order_acquire) == nullptr;
         }
@@ -0,0 +1,240 @@
+// Concurrent_Stack__LF_Static_Array_MPMC.hpp
+//
+// Description:
+//   The solution for the bounded lock-free/static array/MPMC stack problem:
+//     The nodes live in a static array and are addressed by 32-bit indices.
+//     Two Treiber stacks share the node array:
+//       _top : the stack of the nodes holding data
+//       _free: the stack of the free nodes
+//     The heads of both stacks are packed {index, version} words.
+//     The version is incremented by each successful CAS
+//     which solves the ABA problem without the hazard pointers.
+//     The nodes are never deallocated (they only move between the two stacks).
+//     Hence, no allocation and no memory reclamation are required.
+//
+//   For small T (e.g. IDs and handles) the contiguous node array is far more cache friendly
+//   than the linked stacks which allocate per push and chase the pointers on every pop:
+//     Concurrent_Stack__LF_Linked_MPSC.hpp
+//     Concurrent_Stack__LF_Linked_Hazard_MPMC.hpp
+//
+// Requirements:
+// - T must be noexcept-movable.
+//
+// Semantics:
+//   push():
+//     1. Pop a free node from the _free stack (return false if the stack is full)
+//     2. Construct the data into the node
+//     3. Set the next index of the node to the current _top
+//     4. Apply CAS on the _top: CAS({top_index, version}, {node_index, version + 1})
+//   pop():
+//     1. Apply CAS on the _top: CAS({top_index, version}, {top->_next, version + 1})
+//        (return std::nullopt if the stack is empty)
+//     2. Move the data out from the old top node and destroy the node object
+//     3. Push the old top node to the _free stack
+//     4. Return the data
+//
+// Progress:
+//   Lock-free:
+//     Lock-free execution as the threads serializing on the two heads
+//     are bound to functions (push and pop) with constant time complexity, O(1).
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//   2. A thread may read the _next index of a node
+//      which is concurrently popped and reused by another thread.
+//      The _next index is atomic (no data race) and
+//      the stale value is discarded by the failing versioned CAS.
+//   3. The 32-bit version wraps around after 2^32 successful CAS operations.
+//      A thread must be stalled between its load and CAS
+//      for the whole wrap around period to suffer from the ABA problem.
+//
+// Cautions:
+//   1. The single producer and the single consumer configurations do not simplify this design
+//      as the free list is shared by both.
+//      Hence, the same specialization serves all configurations.
+//   2. Use stack_LF_static_array_MPMC alias at the end of this file
+//      to get the right specialization of Concurrent_Stack
+//      and to achieve the default arguments consistently.
+//
+// TODOs:
+//   1. Consider exponential backoff for the heads
+//      in order to deal with the high CAS contention.
+
+#ifndef CONCURRENT_STACK_LF_STATIC_ARRAY_MPMC_HPP
+#define CONCURRENT_STACK_LF_STATIC_ARRAY_MPMC_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "Concurrent_Stack.hpp"
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    // use stack_LF_static_array_MPMC alias at the end of this file
+    // to get the right specialization of Concurrent_Stack
+    // and to achieve the default arguments consistently.
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    requires ( // for the thread safety of pop as it returns std::optional<T>
+            Capacity_As_Pow2 < 32 &&
+            std::is_nothrow_move_constructible_v<T> &&
+            std::is_nothrow_move_assignable_v<T>)
+    class Concurrent_Stack<
+        true,
+        Enum_Structure_Types::Static_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>>
+    {
+        static constexpr std::size_t _CAPACITY = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::uint32_t _NULL_INDEX = UINT32_MAX;
+
+        struct Array_Node {
+            std::atomic<std::uint32_t> _next{ _NULL_INDEX };
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        // the head packs {index, version} into a single word
+        //   the lower half : the index of the head node
+        //   the upper half : the version incremented by each successful CAS
+        static constexpr std::uint32_t index(std::uint64_t head) noexcept {
+            return static_cast<std::uint32_t>(head);
+        }
+        static constexpr std::uint64_t make_head(std::uint32_t index, std::uint64_t old_head) noexcept {
+            return ((old_head >> 32) + 1) << 32 | index;
+        }
+
+        // the versioned Treiber push of a node to the given head
+        void push_node(std::atomic<std::uint64_t>& head, std::uint32_t node_index) noexcept {
+            std::uint64_t old_head = head.load(std::memory_order_relaxed);
+            do {
+                _nodes[node_index]._next.store(index(old_head), std::memory_order_relaxed);
+            } while (
+                !head.compare_exchange_weak(
+                    old_head,
+                    make_head(node_index, old_head),
+                    std::memory_order_release,
+                    std::memory_order_relaxed));
+        }
+
+        // the versioned Treiber pop of a node from the given head
+        std::uint32_t pop_node(std::atomic<std::uint64_t>& head) noexcept {
+            std::uint64_t old_head = head.load(std::memory_order_acquire);
+            while (
+                index(old_head) != _NULL_INDEX &&
+                !head.compare_exchange_weak(
+                    old_head,
+                    make_head(
+                        _nodes[index(old_head)]._next.load(std::memory_order_relaxed),
+                        old_head),
+                    std::memory_order_acq_rel,
+                    std::memory_order_acquire));
+            return index(old_head);
+        }
+
+    public:
+
+        // link all nodes into the free stack
+        Concurrent_Stack() noexcept {
+            for (std::size_t i = 0; i < _CAPACITY; ++i)
+                _nodes[i]._next.store(
+                    i + 1 < _CAPACITY ? static_cast<std::uint32_t>(i + 1) : _NULL_INDEX,
+                    std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        // destroy the elements that were pushed but not yet popped
+        ~Concurrent_Stack() {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                std::uint32_t node_index = index(_top.value.load(std::memory_order_relaxed));
+                while (node_index != _NULL_INDEX) {
+                    _nodes[node_index].to_ptr()->~T();
+                    node_index = _nodes[node_index]._next.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Stack(const Concurrent_Stack&) = delete;
+        Concurrent_Stack& operator=(const Concurrent_Stack&) = delete;
+        Concurrent_Stack(Concurrent_Stack&&) = delete;
+        Concurrent_Stack& operator=(Concurrent_Stack&&) = delete;
+
+        // push function: Returns false if the stack is full.
+        //   1. Pop a free node from the _free stack
+        //   2. Construct the data into the node
+        //   3. Set the next index of the node to the current _top
+        //   4. Apply CAS on the _top: CAS({top_index, version}, {node_index, version + 1})
+        template <typename U = T>
+        bool push(U&& data) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+            // Step 1
+            const std::uint32_t node_index = pop_node(_free.value);
+            if (node_index == _NULL_INDEX) return false;
+
+            // Step 2
+            ::new (_nodes[node_index].to_ptr()) T(std::forward<U>(data));
+
+            // Steps 3 and 4
+            push_node(_top.value, node_index);
+            return true;
+        }
+
+        // pop function:
+        //   1. Apply CAS on the _top: CAS({top_index, version}, {top->_next, version + 1})
+        //   2. Move the data out from the old top node and destroy the node object
+        //   3. Push the old top node to the _free stack
+        //   4. Return the data
+        std::optional<T> pop() noexcept {
+            // Step 1
+            const std::uint32_t node_index = pop_node(_top.value);
+            if (node_index == _NULL_INDEX) return std::nullopt;
+
+            // Step 2
+            T* ptr = _nodes[node_index].to_ptr();
+            std::optional<T> data{ std::move(*ptr) };
+            if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+
+            // Step 3
+            push_node(_free.value, node_index);
+
+            // Step 4
+            return data;
+        }
+
+        bool empty() const noexcept {
+            return index(_top.value.load(std::memory_order_acquire)) == _NULL_INDEX;
+        }
+
+        inline std::size_t capacity() const noexcept { return _CAPACITY; }
+
+    private:
+
+        // MEMBERS:
+        // The heads of the two Treiber stacks sharing the node array.
+        // Initially, all nodes are in the free stack.
+        cache_line_wrapper<std::atomic<std::uint64_t>> _top{ _NULL_INDEX };
+        cache_line_wrapper<std::atomic<std::uint64_t>> _free{ 0 };
+        Array_Node _nodes[_CAPACITY];
+    };
+
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2>
+    using stack_LF_static_array_MPMC = Concurrent_Stack<
+        true,
+        Enum_Structure_Types::Static_Array,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        std::integral_constant<unsigned char, Capacity_As_Pow2>>;
+} // namespace BA_Concurrency
+
+#endif // CONCURRENT_STACK_LF_STATIC_ARRAY_MPMC_HPP
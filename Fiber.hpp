@@ -0,0 +1,504 @@
+// Fiber.hpp
+//
+// Description:
+//   M:N user-mode stackful fibers running on the workers of a thread pool
+//   (e.g. Thread_Pool__Work_Stealing):
+//     1. A fiber owns a stack and runs a task.
+//     2. A fiber is resumed by a pool job: the worker switches from its own stack to the stack of the fiber.
+//     3. A fiber blocking on a fiber-aware primitive (see Fiber_Sync.hpp) or yielding
+//        switches back to the worker which picks the next job.
+//        Hence, a blocked fiber holds its stack only, not an OS thread.
+//     4. A woken (or yielded) fiber is resubmitted to the pool
+//        and may continue on another worker (the work stealing balances the fibers).
+//   The context switch is a small assembly routine (x86-64 and aarch64 Linux)
+//   saving the callee-saved registers on the current stack and swapping the stack pointers.
+//   The stacks are mmap-ed with a guard page (PROT_NONE) below the stack
+//   so that a stack overflow faults instead of corrupting the memory.
+//   The stacks of the finished fibers are pooled for the reuse.
+//
+// Requirements:
+// - x86-64 or aarch64 Linux.
+// - The tasks must not throw (std::terminate as std::thread).
+// - The scheduler must be destroyed before the pool (the destructor waits for the fibers).
+// - vm.max_map_count must cover two mappings per live fiber (the stack and its guard page)
+//   in addition to the other mappings of the process.
+//   The default limit (65530) allows about 32k live fibers.
+//   Raise it for more (e.g. sysctl vm.max_map_count=262144 for 100k fibers).
+//
+// Design:
+//   The context of a suspended fiber (or a worker) is its stack pointer:
+//     the switch pushes the callee-saved registers (and the floating point control words),
+//     stores the stack pointer into *from_sp, loads to_sp, pops the registers and returns.
+//   A new stack is prepared as if it was suspended by the switch:
+//     the return address is the trampoline calling entry(fiber).
+//   After the switch back to the worker, the worker runs the pending action of the fiber:
+//     finished: release the fiber
+//     yield   : resubmit the fiber
+//     suspend : unlock the mutex of the primitive the fiber waits on
+//               (a waker cannot resume the fiber before its context is saved)
+//
+// Semantics:
+//   Fiber_Scheduler::spawn(task): creates a fiber and submits its first resumption to the pool
+//   this_fiber::yield()         : resubmits the current fiber and switches to the worker
+//   this_fiber::suspend(m)      : switches to the worker which unlocks m (m is locked by the caller)
+//   Fiber::wake()               : resubmits a suspended fiber
+//
+// Progress:
+//   Blocking (the fibers block cooperatively)
+//
+// Notes:
+//   1. The thread-locals are accessed through the non-inline functions:
+//      a fiber may migrate between the workers across a switch
+//      and a cached address of a thread-local would refer to the previous worker.
+//   2. The stacks are mapped with MAP_NORESERVE: a fiber consumes the physical memory
+//      for the touched pages only (e.g. 100k fibers with 64 KiB stacks reserve 6.4 GB of the address space).
+//      The number of the live fibers is bounded by vm.max_map_count instead (see Requirements):
+//      the guard page splits each stack into two mappings
+//      (carving the stacks from a larger mapping does not help as the guard pages split it likewise).
+//
+// Cautions:
+//   1. A fiber must not hold a std::mutex (or any thread-bound lock) across a suspension.
+//      Use Fiber_Mutex (see Fiber_Sync.hpp).
+//   2. The thread-locals of a fiber change across the suspensions (migration).
+//   3. The sanitizers (ASan, TSan) require the fiber switch annotations which are not provided.
+//
+// TODOs:
+//   1. Add the sanitizer annotations (__sanitizer_start_switch_fiber).
+
+#ifndef FIBER_HPP
+#define FIBER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "IThread_Pool.hpp"
+
+#if !defined(__linux__) || !(defined(__x86_64__) || defined(__aarch64__))
+#error "Fiber.hpp supports x86-64 and aarch64 Linux"
+#endif
+
+// the context switch:
+//   void ba_fiber_switch(void** from_sp, void* to_sp)
+// the trampoline of a new fiber:
+//   calls entry(arg) with entry and arg placed in the callee-saved registers of the initial frame
+// Defined as weak symbols in the comdat sections: the header may be included in many translation units.
+extern "C" void ba_fiber_switch(void** from_sp, void* to_sp);
+extern "C" void ba_fiber_trampoline();
+
+#if defined(__x86_64__)
+asm(R"(
+    .section .text.ba_fiber_switch,"axG",@progbits,ba_fiber_switch,comdat
+    .weak ba_fiber_switch
+    .type ba_fiber_switch,@function
+    .p2align 4
+ba_fiber_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $16, %rsp
+    stmxcsr 8(%rsp)
+    fnstcw (%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    fldcw (%rsp)
+    ldmxcsr 8(%rsp)
+    addq $16, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size ba_fiber_switch,.-ba_fiber_switch
+
+    .section .text.ba_fiber_trampoline,"axG",@progbits,ba_fiber_trampoline,comdat
+    .weak ba_fiber_trampoline
+    .type ba_fiber_trampoline,@function
+    .p2align 4
+ba_fiber_trampoline:
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .size ba_fiber_trampoline,.-ba_fiber_trampoline
+    .text
+)");
+#elif defined(__aarch64__)
+asm(R"(
+    .section .text.ba_fiber_switch,"axG",@progbits,ba_fiber_switch,comdat
+    .weak ba_fiber_switch
+    .type ba_fiber_switch,%function
+    .p2align 4
+ba_fiber_switch:
+    sub sp, sp, #176
+    stp x19, x20, [sp, #0]
+    stp x21, x22, [sp, #16]
+    stp x23, x24, [sp, #32]
+    stp x25, x26, [sp, #48]
+    stp x27, x28, [sp, #64]
+    stp x29, x30, [sp, #80]
+    stp d8, d9, [sp, #96]
+    stp d10, d11, [sp, #112]
+    stp d12, d13, [sp, #128]
+    stp d14, d15, [sp, #144]
+    mrs x9, fpcr
+    str x9, [sp, #160]
+    mov x9, sp
+    str x9, [x0]
+    mov sp, x1
+    ldr x9, [sp, #160]
+    msr fpcr, x9
+    ldp x19, x20, [sp, #0]
+    ldp x21, x22, [sp, #16]
+    ldp x23, x24, [sp, #32]
+    ldp x25, x26, [sp, #48]
+    ldp x27, x28, [sp, #64]
+    ldp x29, x30, [sp, #80]
+    ldp d8, d9, [sp, #96]
+    ldp d10, d11, [sp, #112]
+    ldp d12, d13, [sp, #128]
+    ldp d14, d15, [sp, #144]
+    add sp, sp, #176
+    ret
+    .size ba_fiber_switch,.-ba_fiber_switch
+
+    .section .text.ba_fiber_trampoline,"axG",@progbits,ba_fiber_trampoline,comdat
+    .weak ba_fiber_trampoline
+    .type ba_fiber_trampoline,%function
+    .p2align 4
+ba_fiber_trampoline:
+    mov x0, x19
+    blr x20
+    brk #0
+    .size ba_fiber_trampoline,.-ba_fiber_trampoline
+    .text
+)");
+#endif
+
+namespace BA_Concurrency {
+    inline constexpr std::size_t FIBER_STACK_SIZE__DEFAULT = 64 * 1024;
+
+    // the guard-paged stacks: pooled for the reuse
+    class Fiber_Stack_Pool {
+    public:
+        struct Stack {
+            void* _base{};    // the guard page
+            std::size_t _size{}; // including the guard page
+            void* top() const noexcept { return static_cast<unsigned char*>(_base) + _size; }
+        };
+
+        Fiber_Stack_Pool(std::size_t stack_size, std::size_t max_cached)
+            : _page_size(static_cast<std::size_t>(sysconf(_SC_PAGESIZE))),
+              _max_cached(max_cached)
+        {
+            // round up to the pages and add the guard page
+            _stack_size = (stack_size + _page_size - 1) / _page_size * _page_size + _page_size;
+        }
+
+        // Single-threaded context expected.
+        ~Fiber_Stack_Pool() {
+            for (auto& stack : _stacks) munmap(stack._base, stack._size);
+        }
+
+        // Non-copyable/movable for simplicity
+        Fiber_Stack_Pool(const Fiber_Stack_Pool&) = delete;
+        Fiber_Stack_Pool& operator=(const Fiber_Stack_Pool&) = delete;
+        Fiber_Stack_Pool(Fiber_Stack_Pool&&) = delete;
+        Fiber_Stack_Pool& operator=(Fiber_Stack_Pool&&) = delete;
+
+        // throws std::system_error if the mapping fails
+        // (ENOMEM: most likely vm.max_map_count, see Requirements)
+        Stack allocate() {
+            {
+                std::scoped_lock lk(_m);
+                if (!_stacks.empty()) {
+                    Stack stack = _stacks.back();
+                    _stacks.pop_back();
+                    return stack;
+                }
+            }
+            void* base = mmap(
+                nullptr, _stack_size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+            if (base == MAP_FAILED) {
+                const int error = errno;
+                throw std::system_error(
+                    error, std::generic_category(),
+                    error == ENOMEM
+                        ? "Fiber_Stack_Pool: mmap (vm.max_map_count exceeded?)"
+                        : "Fiber_Stack_Pool: mmap");
+            }
+            if (mprotect(base, _page_size, PROT_NONE) != 0) {
+                const int error = errno;
+                munmap(base, _stack_size);
+                throw std::system_error(
+                    error, std::generic_category(),
+                    error == ENOMEM
+                        ? "Fiber_Stack_Pool: mprotect (vm.max_map_count exceeded?)"
+                        : "Fiber_Stack_Pool: mprotect");
+            }
+            return Stack{ base, _stack_size };
+        }
+
+        void release(Stack stack) noexcept {
+            {
+                std::scoped_lock lk(_m);
+                if (_stacks.size() < _max_cached) {
+                    try {
+                        _stacks.push_back(stack);
+                        return;
+                    }
+                    catch (...) {}
+                }
+            }
+            munmap(stack._base, stack._size);
+        }
+
+    private:
+
+        // MEMBERS:
+        const std::size_t _page_size;
+        std::size_t _stack_size{};
+        const std::size_t _max_cached;
+        std::vector<Stack> _stacks;
+        std::mutex _m;
+    };
+
+    class Fiber_Scheduler;
+
+    class Fiber {
+        friend class Fiber_Scheduler;
+
+        enum class Actions : unsigned char { None, Yield, Suspend, Finish };
+
+        // the per-worker context (see Notes 1)
+        struct Worker_Context {
+            void* _sp{};
+            Fiber* _current{};
+        };
+
+        [[gnu::noinline]] static Worker_Context& worker_context() noexcept {
+            static thread_local Worker_Context context;
+            asm volatile("" ::: "memory");
+            return context;
+        }
+
+        static void entry(void* arg) noexcept {
+            Fiber* fiber = static_cast<Fiber*>(arg);
+            fiber->_task(); // noexcept entry: a throwing task terminates
+            fiber->_task = nullptr;
+            fiber->switch_to_worker(Actions::Finish, nullptr);
+        }
+
+        // prepare the initial frame (see Design): switch returns into the trampoline
+        void prepare() noexcept {
+            auto top = reinterpret_cast<std::uintptr_t>(_stack.top()) & ~std::uintptr_t{ 15 };
+#if defined(__x86_64__)
+            // [control words][r15][r14][r13][r12][rbx][rbp][return] with rsp = 0 mod 16 after the return
+            auto* frame = reinterpret_cast<std::uint64_t*>(top - 88);
+            std::uint32_t mxcsr;
+            std::uint16_t fpu_cw;
+            asm volatile("stmxcsr %0" : "=m"(mxcsr));
+            asm volatile("fnstcw %0" : "=m"(fpu_cw));
+            frame[0] = fpu_cw;
+            frame[1] = mxcsr;
+            frame[2] = 0;                                             // r15
+            frame[3] = 0;                                             // r14
+            frame[4] = reinterpret_cast<std::uint64_t>(&Fiber::entry); // r13
+            frame[5] = reinterpret_cast<std::uint64_t>(this);         // r12
+            frame[6] = 0;                                             // rbx
+            frame[7] = 0;                                             // rbp
+            frame[8] = reinterpret_cast<std::uint64_t>(&ba_fiber_trampoline);
+#elif defined(__aarch64__)
+            auto* frame = reinterpret_cast<std::uint64_t*>(top - 176);
+            for (int i = 0; i < 22; ++i) frame[i] = 0;
+            std::uint64_t fpcr;
+            asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+            frame[0] = reinterpret_cast<std::uint64_t>(this);          // x19
+            frame[1] = reinterpret_cast<std::uint64_t>(&Fiber::entry); // x20
+            frame[11] = reinterpret_cast<std::uint64_t>(&ba_fiber_trampoline); // x30
+            frame[20] = fpcr;
+#endif
+            _sp = frame;
+        }
+
+        // the fiber side of the switch: runs the action on the worker after the switch
+        void switch_to_worker(Actions action, std::mutex* to_unlock) noexcept {
+            _action = action;
+            _to_unlock = to_unlock;
+            ba_fiber_switch(&_sp, worker_context()._sp);
+        }
+
+        // the worker side of the switch (a pool job)
+        void resume() noexcept;
+
+        Fiber(Fiber_Scheduler& scheduler, Fiber_Stack_Pool::Stack stack, std::function<void()> task)
+            : _scheduler(&scheduler), _stack(stack), _task(std::move(task))
+        {
+            prepare();
+        }
+
+    public:
+
+        // Non-copyable/movable: the stack holds the pointer to the fiber
+        Fiber(const Fiber&) = delete;
+        Fiber& operator=(const Fiber&) = delete;
+        Fiber(Fiber&&) = delete;
+        Fiber& operator=(Fiber&&) = delete;
+
+        // the fiber running on the calling thread (nullptr if not a fiber)
+        static Fiber* current() noexcept {
+            return worker_context()._current;
+        }
+
+        // resubmits a suspended fiber
+        inline void wake();
+
+        // the current fiber: resubmit and switch to the worker
+        static void yield() noexcept {
+            if (Fiber* fiber = current()) fiber->switch_to_worker(Actions::Yield, nullptr);
+        }
+
+        // the current fiber: switch to the worker which unlocks m (locked by the caller).
+        // returns when woken (m is unlocked).
+        static void suspend(std::mutex& m) noexcept {
+            current()->switch_to_worker(Actions::Suspend, &m);
+        }
+
+    private:
+
+        // MEMBERS:
+        // _action and _to_unlock are written by the fiber before the switch
+        // and read by the worker after the switch (the same thread).
+        Fiber_Scheduler* const _scheduler;
+        const Fiber_Stack_Pool::Stack _stack;
+        std::function<void()> _task;
+        void* _sp{};
+        Actions _action{ Actions::None };
+        std::mutex* _to_unlock{};
+    };
+
+    class Fiber_Scheduler {
+        friend class Fiber;
+
+        void submit(Fiber* fiber) {
+            _pool->submit([fiber] { fiber->resume(); });
+        }
+
+        void finish(Fiber* fiber) noexcept {
+            const auto stack = fiber->_stack;
+            delete fiber;
+            _stacks.release(stack);
+            std::scoped_lock lk(_m);
+            if (--_live == 0) _cv.notify_all();
+        }
+
+    public:
+
+        explicit Fiber_Scheduler(
+            IThread_Pool& pool,
+            std::size_t stack_size = FIBER_STACK_SIZE__DEFAULT,
+            std::size_t max_cached_stacks = 1024)
+                : _pool(&pool), _stacks(stack_size, max_cached_stacks) {}
+
+        // waits for the fibers
+        ~Fiber_Scheduler() {
+            join();
+        }
+
+        // Non-copyable/movable for simplicity
+        Fiber_Scheduler(const Fiber_Scheduler&) = delete;
+        Fiber_Scheduler& operator=(const Fiber_Scheduler&) = delete;
+        Fiber_Scheduler(Fiber_Scheduler&&) = delete;
+        Fiber_Scheduler& operator=(Fiber_Scheduler&&) = delete;
+
+        // creates a fiber running the task on the pool
+        void spawn(std::function<void()> task) {
+            auto stack = _stacks.allocate();
+            Fiber* fiber;
+            try {
+                fiber = new Fiber(*this, stack, std::move(task));
+            }
+            catch (...) {
+                _stacks.release(stack);
+                throw;
+            }
+            {
+                std::scoped_lock lk(_m);
+                ++_live;
+            }
+            submit(fiber);
+        }
+
+        // waits until all fibers finish (must not be called from a fiber)
+        void join() {
+            std::unique_lock lk(_m);
+            _cv.wait(lk, [this] { return _live == 0; });
+        }
+
+        std::size_t live_fiber_count() const {
+            std::scoped_lock lk(_m);
+            return _live;
+        }
+
+    private:
+
+        // MEMBERS:
+        IThread_Pool* const _pool;
+        Fiber_Stack_Pool _stacks;
+        std::size_t _live{};
+        mutable std::mutex _m;
+        std::condition_variable _cv;
+    };
+
+    // 1. Switch to the fiber
+    // 2. Run the action of the fiber (see Design)
+    inline void Fiber::resume() noexcept {
+        // Step 1
+        Worker_Context& context = worker_context();
+        Fiber* const outer = context._current;
+        context._current = this;
+        ba_fiber_switch(&context._sp, _sp);
+        context._current = outer;
+
+        // Step 2: the fiber may be resumed elsewhere right after the unlock
+        switch (_action) {
+            case Actions::Finish:
+                _scheduler->finish(this);
+                break;
+            case Actions::Yield:
+                _scheduler->submit(this);
+                break;
+            case Actions::Suspend:
+                _to_unlock->unlock();
+                break;
+            default:
+                break;
+        }
+    }
+
+    inline void Fiber::wake() {
+        _scheduler->submit(this);
+    }
+
+    namespace this_fiber {
+        inline void yield() noexcept { Fiber::yield(); }
+        inline bool is_fiber() noexcept { return Fiber::current() != nullptr; }
+    } // namespace this_fiber
+} // namespace BA_Concurrency
+
+#endif // FIBER_HPP
@@ -0,0 +1,350 @@
+// Fiber_Sync.hpp
+//
+// Description:
+//   The fiber-aware synchronization primitives (see Fiber.hpp):
+//     Fiber_Mutex            : the mutex handing the ownership over to the next waiter
+//     Concurrent_Queue__Fiber: the blocking MPMC queue (IConcurrent_Queue)
+//     Fiber_Promise/Fiber_Future: the one-shot value channel (and spawn_async)
+//   A fiber blocking on a primitive suspends itself (releases its worker)
+//   instead of blocking the OS thread.
+//   A plain thread (e.g. the main thread) blocks on a condition variable as usual.
+//   Hence, the fibers and the threads may share a primitive
+//   (e.g. the main thread waits for the future of a fiber).
+//
+// Requirements:
+// - See Fiber.hpp.
+//
+// Design:
+//   Fiber_Wait_List: the FIFO of the waiters guarded by the mutex of the primitive.
+//     A waiter is a node on the stack of the waiting fiber (or thread):
+//       _fiber: the waiting fiber (nullptr for a thread)
+//       _woken: set by the notifier
+//     wait: enqueue the waiter and
+//             fiber : suspend (the worker unlocks the mutex after the switch, see Fiber.hpp)
+//             thread: wait on the condition variable
+//     notify: dequeue the waiter, set _woken and wake the fiber (or notify the threads)
+//
+// Semantics:
+//   Fiber_Mutex::unlock hands the ownership over to the first waiter (no barging, FIFO).
+//   Concurrent_Queue__Fiber::pop returns std::nullopt when the queue is closed and empty.
+//   Fiber_Future::get rethrows the exception set by the promise.
+//
+// Progress:
+//   Blocking
+//
+// Cautions:
+//   1. The internal std::mutex of a primitive is never held across a suspension.
+
+#ifndef FIBER_SYNC_HPP
+#define FIBER_SYNC_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "Fiber.hpp"
+#include "IConcurrent_Queue.hpp"
+#include "Concurrent_Queue.hpp"
+#include "enum_structure_types.hpp"
+#include "enum_concurrency_models.hpp"
+
+namespace BA_Concurrency {
+    class Fiber_Wait_List {
+        struct Waiter {
+            Fiber* _fiber;
+            bool _woken{ false };
+            Waiter* _next{};
+        };
+
+        Waiter* pop() noexcept {
+            Waiter* waiter = _head;
+            _head = waiter->_next;
+            if (!_head) _tail = nullptr;
+            return waiter;
+        }
+
+        void wake(Waiter* waiter) {
+            waiter->_woken = true;
+            if (waiter->_fiber) waiter->_fiber->wake();
+            else _cv.notify_all();
+        }
+
+    public:
+
+        // lk holds the mutex of the primitive. returns when notified (lk is locked).
+        void wait(std::unique_lock<std::mutex>& lk) {
+            Waiter waiter{ Fiber::current() };
+            if (_tail) _tail->_next = &waiter;
+            else _head = &waiter;
+            _tail = &waiter;
+
+            if (waiter._fiber) {
+                // the worker unlocks the mutex after saving the context of the fiber
+                std::mutex* m = lk.release();
+                Fiber::suspend(*m);
+                lk = std::unique_lock<std::mutex>(*m);
+            }
+            else
+                _cv.wait(lk, [&] { return waiter._woken; });
+        }
+
+        // lk must hold the mutex of the primitive. returns false if there is no waiter.
+        bool notify_one() {
+            if (!_head) return false;
+            wake(pop());
+            return true;
+        }
+
+        void notify_all() {
+            while (_head) wake(pop());
+        }
+
+        bool empty() const noexcept { return _head == nullptr; }
+
+    private:
+
+        // MEMBERS:
+        Waiter* _head{};
+        Waiter* _tail{};
+        std::condition_variable _cv;
+    };
+
+    class Fiber_Mutex {
+    public:
+
+        Fiber_Mutex() = default;
+
+        // Non-copyable/movable for simplicity
+        Fiber_Mutex(const Fiber_Mutex&) = delete;
+        Fiber_Mutex& operator=(const Fiber_Mutex&) = delete;
+        Fiber_Mutex(Fiber_Mutex&&) = delete;
+        Fiber_Mutex& operator=(Fiber_Mutex&&) = delete;
+
+        // waits for the hand-over if locked
+        void lock() {
+            std::unique_lock lk(_m);
+            if (!_locked) {
+                _locked = true;
+                return;
+            }
+            _waiters.wait(lk);
+        }
+
+        bool try_lock() {
+            std::scoped_lock lk(_m);
+            if (_locked) return false;
+            _locked = true;
+            return true;
+        }
+
+        // hands the ownership over to the first waiter (_locked stays true)
+        void unlock() {
+            std::scoped_lock lk(_m);
+            if (!_waiters.notify_one()) _locked = false;
+        }
+
+    private:
+
+        // MEMBERS:
+        std::mutex _m;
+        bool _locked{ false };
+        Fiber_Wait_List _waiters;
+    };
+
+    struct Fiber_Aware {};
+
+    template <typename T>
+    class Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Fiber_Aware> : public IConcurrent_Queue<T> {
+    public:
+
+        Concurrent_Queue() = default;
+
+        // Non-copyable/movable for simplicity
+        Concurrent_Queue(const Concurrent_Queue&) = delete;
+        Concurrent_Queue& operator=(const Concurrent_Queue&) = delete;
+        Concurrent_Queue(Concurrent_Queue&&) = delete;
+        Concurrent_Queue& operator=(Concurrent_Queue&&) = delete;
+
+        inline void push(T data) override {
+            std::scoped_lock lk(_m);
+            _items.push_back(std::move(data));
+            _consumers.notify_one();
+        }
+
+        // returns std::nullopt if the queue is closed and empty
+        inline std::optional<T> pop() override {
+            std::unique_lock lk(_m);
+            while (_items.empty() && !_closed) _consumers.wait(lk);
+            return take();
+        }
+
+        inline std::optional<T> try_pop() override {
+            std::scoped_lock lk(_m);
+            return take();
+        }
+
+        // wake the waiting consumers: pop returns std::nullopt when the queue is empty
+        void close() {
+            std::scoped_lock lk(_m);
+            _closed = true;
+            _consumers.notify_all();
+        }
+
+        inline size_t size() const noexcept override {
+            std::scoped_lock lk(_m);
+            return _items.size();
+        }
+
+        inline bool empty() const noexcept override {
+            std::scoped_lock lk(_m);
+            return _items.empty();
+        }
+
+    private:
+
+        std::optional<T> take() {
+            if (_items.empty()) return std::nullopt;
+            std::optional<T> data{ std::move(_items.front()) };
+            _items.pop_front();
+            return data;
+        }
+
+        // MEMBERS:
+        std::deque<T> _items;
+        bool _closed{ false };
+        Fiber_Wait_List _consumers;
+        mutable std::mutex _m;
+    };
+
+    template <typename T>
+    using Concurrent_Queue__Fiber = Concurrent_Queue<
+        false,
+        Enum_Structure_Types::Linked,
+        Enum_Concurrency_Models::MPMC,
+        T,
+        Fiber_Aware>;
+
+    // the shared state of Fiber_Promise and Fiber_Future
+    template <typename T>
+    struct Fiber_Shared_State {
+        using stored_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+        std::mutex _m;
+        std::optional<stored_t> _value;
+        std::exception_ptr _error;
+        bool _ready{ false };
+        Fiber_Wait_List _waiters;
+
+        void wait(std::unique_lock<std::mutex>& lk) {
+            while (!_ready) _waiters.wait(lk);
+        }
+
+        template <typename F>
+        void complete(F&& set) {
+            std::scoped_lock lk(_m);
+            if (_ready) throw std::logic_error("Fiber_Promise: already satisfied");
+            set();
+            _ready = true;
+            _waiters.notify_all();
+        }
+    };
+
+    template <typename T>
+    class Fiber_Future {
+        template <typename> friend class Fiber_Promise;
+
+        explicit Fiber_Future(std::shared_ptr<Fiber_Shared_State<T>> state) noexcept
+            : _state(std::move(state)) {}
+
+    public:
+
+        Fiber_Future() = default;
+
+        bool valid() const noexcept { return _state != nullptr; }
+
+        bool is_ready() const {
+            std::scoped_lock lk(_state->_m);
+            return _state->_ready;
+        }
+
+        void wait() const {
+            std::unique_lock lk(_state->_m);
+            _state->wait(lk);
+        }
+
+        // waits for the value (or rethrows the exception). the future is invalidated.
+        T get() {
+            auto state = std::move(_state);
+            std::unique_lock lk(state->_m);
+            state->wait(lk);
+            if (state->_error) std::rethrow_exception(state->_error);
+            if constexpr (!std::is_void_v<T>) return std::move(*state->_value);
+        }
+
+    private:
+
+        // MEMBERS:
+        std::shared_ptr<Fiber_Shared_State<T>> _state;
+    };
+
+    template <typename T>
+    class Fiber_Promise {
+    public:
+
+        Fiber_Promise() : _state(std::make_shared<Fiber_Shared_State<T>>()) {}
+
+        Fiber_Future<T> get_future() const {
+            return Fiber_Future<T>(_state);
+        }
+
+        template <typename... Args>
+        void set_value(Args&&... args) {
+            _state->complete([&] { _state->_value.emplace(std::forward<Args>(args)...); });
+        }
+
+        void set_exception(std::exception_ptr error) {
+            _state->complete([&] { _state->_error = std::move(error); });
+        }
+
+    private:
+
+        // MEMBERS:
+        std::shared_ptr<Fiber_Shared_State<T>> _state;
+    };
+
+    // runs f on a new fiber and returns the future of its result
+    template <typename F>
+    auto spawn_async(Fiber_Scheduler& scheduler, F f) -> Fiber_Future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        Fiber_Promise<R> promise;
+        auto future = promise.get_future();
+        scheduler.spawn([promise = std::move(promise), f = std::move(f)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    f();
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(f());
+            }
+            catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+} // namespace BA_Concurrency
+
+#endif // FIBER_SYNC_HPP
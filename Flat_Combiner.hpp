@@ -0,0 +1,253 @@
+// Flat_Combiner.hpp
+//
+// Description:
+//   A generic flat-combining wrapper for the sequential data structures
+//   (e.g. priority heaps, LRU lists) which have no good lock-free design:
+//     1. Each thread publishes its operation into a publication record,
+//     2. The thread acquiring the combiner lock becomes the combiner
+//        and applies all published operations in a batch,
+//     3. The other threads spin on their own publication records
+//        until the combiner marks them as DONE.
+//
+//   The combiner touches the sequential data structure back-to-back
+//   for the whole batch while the data structure stays in its cache.
+//   Hence, under high contention, flat-combining beats the mutex
+//   (a cache line transfer per operation) and the CAS loops
+//   (a failed CAS per conflicting operation).
+//
+// Requirements:
+// - Sequential must be constructible from the constructor arguments.
+// - An operation throwing an exception must leave the Sequential valid
+//   (at least the basic exception guarantee).
+//
+// Design:
+//   Publication_Record:
+//     Cache line aligned (no false sharing between the publishers) record with:
+//       _owned    : the record is acquired by a thread
+//       _state    : EMPTY, PENDING or DONE
+//       _operation: type erased operation: void(*)(void* context, Sequential&)
+//       _context  : the operation and the result living in the stack frame of the publisher
+//     The type erasure follows Memory_Reclaimer in Hazard_Ptr.hpp
+//     which avoids the heap allocation of std::function.
+//
+//   The publisher waits in apply() until its operation is DONE.
+//   Hence, the context living in the stack frame of the publisher
+//   is valid during the execution by the combiner.
+//
+//   An exception thrown by an operation is caught by the combiner,
+//   stored in the context of the operation and rethrown by apply() in the publishing thread.
+//   Hence, the combiner completes the batch and the other publishers are not affected.
+//
+// Semantics:
+//   apply(f):
+//     1. Acquire a publication record (CAS on _owned starting from the thread's hashed index)
+//     2. Store the operation and the context
+//     3. Publish the record: _state.store(PENDING, std::memory_order_release)
+//     4. Loop until the record is DONE:
+//        IF the combiner lock is acquired:
+//          Apply all PENDING records (including its own) and mark them as DONE
+//          Release the combiner lock
+//        ELSE
+//          Spin on the own record
+//     5. Release the record and return the result (or rethrow the exception of the operation)
+//
+// Progress:
+//   Blocking:
+//     The combiner holds a lock while applying the batch.
+//     A descheduled combiner blocks all publishers.
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//   2. Publication_Slot_Count bounds the number of concurrent publishers.
+//      Excess threads spin until a record is released.
+//
+// Cautions:
+//   1. Use the FC stack and queue aliases to get the flat-combining versions of
+//      Concurrent_Stack and Concurrent_Queue__Blocking:
+//        Concurrent_Stack__Flat_Combining.hpp
+//        Concurrent_Queue__Flat_Combining.hpp
+//
+// TODOs:
+//   1. Consider exponential backoff for the spinning publishers.
+
+#ifndef FLAT_COMBINER_HPP
+#define FLAT_COMBINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <optional>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    inline constexpr std::size_t FLAT_COMBINING_SLOT_COUNT__DEFAULT = 64;
+
+    template <
+        typename Sequential,
+        std::size_t Publication_Slot_Count = FLAT_COMBINING_SLOT_COUNT__DEFAULT>
+    requires (Publication_Slot_Count > 0)
+    class Flat_Combiner {
+        // the number of passes over the publication records per combining session
+        static constexpr std::size_t _COMBINING_PASS_COUNT = 2;
+
+        enum Record_States : std::uint8_t { EMPTY, PENDING, DONE };
+
+        struct Publication_Record {
+            std::atomic<bool> _owned{ false };
+            std::atomic<std::uint8_t> _state{ EMPTY };
+            void (*_operation)(void*, Sequential&) noexcept {};
+            void *_context{};
+        };
+        using _CLWR = cache_line_wrapper<Publication_Record>;
+
+        // the context of an operation living in the stack frame of the publisher
+        // the exception of the operation is stored for the publisher
+        template <typename F, typename R>
+        struct Operation_Context {
+            F* _f;
+            std::optional<R> _result{};
+            std::exception_ptr _error{};
+            static void execute(void *context, Sequential& sequential) noexcept {
+                auto* operation_context = static_cast<Operation_Context*>(context);
+                try {
+                    operation_context->_result.emplace(std::invoke(*operation_context->_f, sequential));
+                }
+                catch (...) {
+                    operation_context->_error = std::current_exception();
+                }
+            }
+        };
+        template <typename F>
+        struct Operation_Context<F, void> {
+            F* _f;
+            std::exception_ptr _error{};
+            static void execute(void *context, Sequential& sequential) noexcept {
+                auto* operation_context = static_cast<Operation_Context*>(context);
+                try {
+                    std::invoke(*operation_context->_f, sequential);
+                }
+                catch (...) {
+                    operation_context->_error = std::current_exception();
+                }
+            }
+        };
+
+        // acquire a publication record starting from the hashed thread id
+        // in order to minimize the collisions between the publishers
+        Publication_Record& acquire_record() noexcept {
+            std::size_t index =
+                std::hash<std::thread::id>{}(std::this_thread::get_id()) % Publication_Slot_Count;
+            while (true) {
+                for (std::size_t i = 0; i < Publication_Slot_Count; ++i) {
+                    auto& record = _records[index].value;
+                    bool expected{ false };
+                    if (
+                        !record._owned.load(std::memory_order_relaxed) &&
+                        record._owned.compare_exchange_strong(
+                            expected,
+                            true,
+                            std::memory_order_acquire,
+                            std::memory_order_relaxed))
+                        return record;
+                    if (++index == Publication_Slot_Count) index = 0;
+                }
+                // all records are in use
+                std::this_thread::yield();
+            }
+        }
+
+        // apply the published operations in a batch.
+        // the caller holds the combiner lock.
+        // the operations never throw here: the exceptions are stored in their contexts.
+        void combine() noexcept {
+            for (std::size_t pass = 0; pass < _COMBINING_PASS_COUNT; ++pass) {
+                bool applied{};
+                for (auto& record_wrapper : _records) {
+                    auto& record = record_wrapper.value;
+                    if (record._state.load(std::memory_order_acquire) != PENDING) continue;
+                    record._operation(record._context, _sequential);
+                    record._state.store(DONE, std::memory_order_release);
+                    applied = true;
+                }
+                if (!applied) break;
+            }
+        }
+
+        bool try_lock() noexcept {
+            return
+                !_lock.value.load(std::memory_order_relaxed) &&
+                !_lock.value.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() noexcept {
+            _lock.value.store(false, std::memory_order_release);
+        }
+
+    public:
+
+        template <typename... Args>
+        explicit Flat_Combiner(Args&&... args)
+            : _sequential(std::forward<Args>(args)...) {}
+
+        // Non-copyable/movable for simplicity
+        Flat_Combiner(const Flat_Combiner&) = delete;
+        Flat_Combiner& operator=(const Flat_Combiner&) = delete;
+        Flat_Combiner(Flat_Combiner&&) = delete;
+        Flat_Combiner& operator=(Flat_Combiner&&) = delete;
+
+        // apply the operation f(Sequential&) via flat-combining
+        //   1. Acquire a publication record
+        //   2. Store the operation and the context
+        //   3. Publish the record
+        //   4. Combine or spin until the record is DONE
+        //   5. Release the record and return the result
+        // rethrows the exception thrown by f
+        template <typename F>
+        requires std::invocable<F&, Sequential&>
+        auto apply(F&& f) -> std::invoke_result_t<F&, Sequential&> {
+            using R = std::invoke_result_t<F&, Sequential&>;
+            using _OC = Operation_Context<std::remove_reference_t<F>, R>;
+            _OC operation_context{ &f };
+
+            // Step 1
+            Publication_Record& record = acquire_record();
+
+            // Step 2
+            record._operation = &_OC::execute;
+            record._context = &operation_context;
+
+            // Step 3
+            record._state.store(PENDING, std::memory_order_release);
+
+            // Step 4
+            while (record._state.load(std::memory_order_acquire) != DONE) {
+                if (try_lock()) {
+                    combine();
+                    unlock();
+                }
+                else std::this_thread::yield();
+            }
+
+            // Step 5
+            record._state.store(EMPTY, std::memory_order_relaxed);
+            record._owned.store(false, std::memory_order_release);
+            if (operation_context._error) std::rethrow_exception(operation_context._error);
+            if constexpr (!std::is_void_v<R>)
+                return std::move(*operation_context._result);
+        }
+
+    private:
+        cache_line_wrapper<std::atomic<bool>> _lock{ false }; // the combiner lock
+        _CLWR _records[Publication_Slot_Count];
+        Sequential _sequential;
+    };
+} // namespace BA_Concurrency
+
+#endif // FLAT_COMBINER_HPP
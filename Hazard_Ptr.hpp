@@ -17,9 +17,12 @@
 // Design:
 //   Types:
 //     Hazard_Ptr_Record:
-//       Defines the hazard ptr with two atomic members (safe synchronized access):
+//       Defines the hazard ptr with three atomic members (safe synchronized access):
 //         _owner_thread: the thread requesting the hazard ptr
 //         _ptr         : the ptr to be protected by the hazard ptr
+//         _exclusive   : the record is not shared with the other owners of the thread
+//       A record is padded to a cache line:
+//       the owner thread writes only its own line (the reclamation scans read all lines).
 //     Memory_Reclaimer:
 //       Defines the memory reclamation logic with two members:
 //         _ptr    : the ptr for which the pointee will be deleted
@@ -71,6 +74,16 @@
 //      This function is called by reclaim_memory_later
 //      when the number of the size of MEMORY_RECLAIMERS reaches the treshold value
 //      which is set as the half of HAZARD_PTR_RECORD_COUNT template parameter.
+//   5. Static Hazard_Ptr_Owner::is_protected function
+//      checks a single ptr against HAZARD_PTR_RECORDS without an allocation.
+//   6. Static Hazard_Ptr_Owner::reserve_reclaim_list function
+//      reserves MEMORY_RECLAIMERS so that the reserved ptrs are listed without an allocation.
+//   7. The default constructed Hazard_Ptr_Owners of a thread share a single record (re-entrant).
+//      Hence, an owner living across the calls into the other hazard ptr structures
+//      (e.g. the cursor of Concurrent_Log) would lose its protection
+//      to the protect and the destructor of the nested owners.
+//      Hazard_Ptr_Owner(Hazard_Ptr_Exclusive) acquires a record which is not shared:
+//      the re-entrant search skips the exclusive records.
 
 #ifndef HAZARD_PTR_HPP
 #define HAZARD_PTR_HPP
@@ -91,12 +104,16 @@
 namespace BA_Concurrency {
     inline constexpr std::size_t HAZARD_PTR_RECORD_COUNT__DEFAULT = 128;
 
-    // a record for the hazard ptrs
-    struct Hazard_Ptr_Record {
+    // a record for the hazard ptrs (a cache line per record)
+    struct alignas(64) Hazard_Ptr_Record {
         std::atomic<std::thread::id> _owner_thread{};
         std::atomic<void*> _ptr{ nullptr };
+        std::atomic<bool> _exclusive{ false };
     };
 
+    // the tag of the hazard ptr owners with a record not shared by the thread (see Semantics 7)
+    struct Hazard_Ptr_Exclusive {};
+
     // deferred memory reclamation wrapper
     struct Memory_Reclaimer {
         void *_ptr{};
@@ -127,34 +144,44 @@ namespace BA_Concurrency {
         Hazard_Ptr_Record* _hazard_ptr_record;
 
         // get an unpublished hazard pointer
+        // exclusive: do not share the record with the other owners of the thread (see Semantics 7)
         // CAUTION: See TODO comment at the end of the function
-        static Hazard_Ptr_Record* acquire_hazard_ptr_record() {
+        static Hazard_Ptr_Record* acquire_hazard_ptr_record(bool exclusive = false) {
             auto this_tid = std::this_thread::get_id();
 
             // if already owned (re-entrant use in same thread)
+            // the exclusive flag is written and read only by the owner thread
             auto ite{ std::end(HAZARD_PTR_RECORDS) };
-            if (
-                auto it = std::find_if(
-                    std::begin(HAZARD_PTR_RECORDS),
-                    ite,
-                    [&this_tid](const auto& hazard_ptr_record) {
-                        return hazard_ptr_record._owner_thread.load(std::memory_order_acquire) == this_tid;
-                    });
-                it != ite)
-            {
-                return &*it;
+            if (!exclusive) {
+                if (
+                    auto it = std::find_if(
+                        std::begin(HAZARD_PTR_RECORDS),
+                        ite,
+                        [&this_tid](const auto& hazard_ptr_record) {
+                            return
+                                hazard_ptr_record._owner_thread.load(std::memory_order_acquire) == this_tid &&
+                                !hazard_ptr_record._exclusive.load(std::memory_order_relaxed);
+                        });
+                    it != ite)
+                {
+                    return &*it;
+                }
             }
 
             // find an unpublished hazard ptr record
-            std::thread::id empty_tid{};
-            for (auto& hazard_ptr_record : HAZARD_PTR_RECORDS)
+            for (auto& hazard_ptr_record : HAZARD_PTR_RECORDS) {
+                std::thread::id empty_tid{};
                 if (
                     hazard_ptr_record._owner_thread.compare_exchange_strong(
                         empty_tid,
                         this_tid,
                         std::memory_order_acq_rel,
                         std::memory_order_relaxed))
+                {
+                    hazard_ptr_record._exclusive.store(exclusive, std::memory_order_relaxed);
                     return &hazard_ptr_record;
+                }
+            }
             // TODO:
             //   all hazard ptr records are in use.
             //   either increase HAZARD_PTR_RECORD_COUNT or use a dynamic registry.
@@ -166,6 +193,7 @@ namespace BA_Concurrency {
         void reset() {
             if (!_hazard_ptr_record) return;
             _hazard_ptr_record->_ptr.store(nullptr, std::memory_order_release);
+            _hazard_ptr_record->_exclusive.store(false, std::memory_order_relaxed);
             _hazard_ptr_record->_owner_thread.store(std::thread::id{}, std::memory_order_release);
             _hazard_ptr_record = nullptr;
         }
@@ -190,6 +218,7 @@ namespace BA_Concurrency {
     public:
 
         Hazard_Ptr_Owner() : _hazard_ptr_record(acquire_hazard_ptr_record()) {}
+        explicit Hazard_Ptr_Owner(Hazard_Ptr_Exclusive) : _hazard_ptr_record(acquire_hazard_ptr_record(true)) {}
         Hazard_Ptr_Owner(Hazard_Ptr_Owner&& rhs) noexcept
             : _hazard_ptr_record(rhs._hazard_ptr_record)
         {
@@ -242,6 +271,24 @@ namespace BA_Concurrency {
             MEMORY_RECLAIMERS.swap(memory_reclaimers__protected); // reclaimers with active hazard ptrs
         }
 
+        // true if the ptr is protected by a hazard ptr (no allocation unlike the reclamation scan)
+        static bool is_protected(const void* ptr) noexcept {
+            std::thread::id empty_tid{};
+            for (auto& hazard_ptr_record : HAZARD_PTR_RECORDS)
+                if (
+                    hazard_ptr_record._owner_thread.load(std::memory_order_acquire) != empty_tid &&
+                    hazard_ptr_record._ptr.load(std::memory_order_acquire) == ptr)
+                    return true;
+            return false;
+        }
+
+        // reserve the deferred reclamation list of this thread for count more ptrs.
+        // reclaim_memory_later lists the reserved ptrs without an allocation
+        // (the threshold reclamation may still throw std::bad_alloc before deleting any ptr).
+        static void reserve_reclaim_list(std::size_t count) {
+            MEMORY_RECLAIMERS.reserve(MEMORY_RECLAIMERS.size() + count);
+        }
+
         // add the ptr into the deferred reclamation list
         static inline void reclaim_memory_later(void *ptr, void *context, void (*deleter)(void*, void*)) {
             MEMORY_RECLAIMERS.push_back(Memory_Reclaimer{ptr, context, deleter});
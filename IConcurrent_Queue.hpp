@@ -3,6 +3,8 @@
 #ifndef ICONCURRENT_QUEUE_HPP
 #define ICONCURRENT_QUEUE_HPP
 
+#include <chrono>
+#include <cstddef>
 #include <optional>
 
 namespace BA_Concurrency {
@@ -16,6 +18,12 @@ namespace BA_Concurrency {
         virtual std::optional<T> try_pop() = 0;
         virtual size_t size() const = 0;
         virtual bool empty() const = 0;
+
+        // the monitoring (see Queue_Monitor.hpp):
+        //   approximate_size: a cheap depth estimate without the synchronization of size
+        //   oldest_item_age : the time spent in the queue by the front item (zero if not tracked)
+        virtual std::size_t approximate_size() const { return size(); }
+        virtual std::chrono::nanoseconds oldest_item_age() const { return std::chrono::nanoseconds::zero(); }
     };
 } // namespace BA_Concurrency
 
@@ -0,0 +1,369 @@
+// Parallel_Pipeline.hpp
+//
+// Description:
+//   A token-limited multi-stage pipeline (parallel_pipeline of TBB) running on a thread pool
+//   (e.g. Thread_Pool__Work_Stealing):
+//     1. The stages (the filters) are declared as
+//          Serial_In_Order    : one item at a time in the input order
+//          Serial_Out_Of_Order: one item at a time in any order
+//          Parallel           : any number of items concurrently
+//     2. The filters are chained by operator& and the types of the chain are checked statically:
+//          make_filter<void, A>(mode, f) & make_filter<A, B>(mode, g) & make_filter<B, void>(mode, h)
+//        The first filter (the input) is always serial and stops the pipeline by Flow_Control::stop.
+//     3. The number of the tokens (the items in flight) is bounded by max_tokens.
+//        Hence, the memory of the pipeline is fixed.
+//     4. An item flows through the consecutive stages on the same worker (the cache locality)
+//        until a serial stage is busy or the item is out of order for an in-order stage.
+//
+// Requirements:
+// - Executor must provide submit(std::function<void()>).
+// - The filters must not throw.
+// - The item types must be copy constructible (the items are type-erased by std::any).
+//
+// Design:
+//   Token: the item of a stage (std::any) and the sequence number assigned by the input
+//   _free: the ring queue of the free tokens (queue_LF_ring_MPMC)
+//   Serial gate (a serial stage):
+//     _busy    : the flag of the running item (see Strand.hpp)
+//     _queue   : the ring queue of the waiting tokens (Serial_Out_Of_Order)
+//     _slots   : the sequence-indexed ring of the waiting tokens (Serial_In_Order)
+//     _next_seq: the next sequence to be processed (Serial_In_Order)
+//   The rings are sized by Token_Count_As_Pow2 >= max_tokens.
+//   Hence, the rings never overflow and the waiting sequences never collide.
+//
+// Semantics:
+//   input:
+//     1. Acquire the input gate and a free token
+//     2. Run the input filter into the token and assign the sequence
+//     3. Release the input gate (submit an input task if free tokens remain)
+//     4. Flow the token through the stages
+//   flow(token, stage):
+//     Parallel stage: run the filter on this worker and continue with the next stage
+//     Serial stage  : deposit the token into the gate and try to acquire the gate:
+//                       On success, run the filter on a processable token (not necessarily this token)
+//                       and continue the processed token with the next stage
+//                       On failure, return (the gate holder processes the token)
+//     The end: release the token and run the input
+//   release of a serial gate:
+//     Clear _busy and re-check the waiting tokens (see Strand.hpp).
+//     If a token is processable, acquire the gate again and submit a task for the token.
+//
+// Progress:
+//   Blocking: the caller waits for the completion of the pipeline.
+//   The workers never block on a gate.
+//
+// Notes:
+//   1. The clearing of _busy and the re-check of the waiting tokens are separated
+//      by a sequentially consistent fence (store-load ordering).
+//   2. The run state is shared by the tasks (std::shared_ptr).
+//      Hence, a late task finding nothing to do is safe after the completion.
+//
+// Cautions:
+//   1. Do not call parallel_pipeline from a worker of the same pool
+//      as the caller blocks.
+//
+// TODOs:
+//   1. Consider the typed token storage instead of std::any (no allocation for the large items).
+
+#ifndef PARALLEL_PIPELINE_HPP
+#define PARALLEL_PIPELINE_HPP
+
+#include <any>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "aux_type_traits.hpp"
+#include "Concurrent_Queue__LF_Ring_MPMC.hpp"
+
+namespace BA_Concurrency {
+    enum class Filter_Modes : std::uint8_t {
+        Serial_In_Order,
+        Serial_Out_Of_Order,
+        Parallel };
+
+    class Flow_Control {
+    public:
+        void stop() noexcept { _stopped = true; }
+        bool is_stopped() const noexcept { return _stopped; }
+
+    private:
+        bool _stopped{};
+    };
+
+    // the type-erased stage of a filter chain
+    struct Pipeline_Stage {
+        Filter_Modes _mode;
+        std::function<void(std::any&, Flow_Control&)> _body;
+    };
+
+    template <typename In, typename Out>
+    class Filter {
+        template <typename In_, typename Out_, typename F>
+        friend Filter<In_, Out_> make_filter(Filter_Modes, F);
+
+        template <typename A, typename B, typename C>
+        friend Filter<A, C> operator&(Filter<A, B>, Filter<B, C>);
+
+        template <unsigned char, typename Executor>
+        friend void parallel_pipeline(Executor&, std::size_t, const Filter<void, void>&);
+
+        explicit Filter(std::vector<Pipeline_Stage> stages) : _stages(std::move(stages)) {}
+
+        // MEMBERS:
+        std::vector<Pipeline_Stage> _stages;
+    };
+
+    // the filter of a stage:
+    //   In == void: the input filter: Out f(Flow_Control&)
+    //   otherwise : Out f(In) (void f(In) for Out == void)
+    template <typename In, typename Out, typename F>
+    Filter<In, Out> make_filter(Filter_Modes mode, F f) {
+        Pipeline_Stage stage{ mode, {} };
+        if constexpr (std::is_void_v<In>)
+            stage._body = [f = std::move(f)](std::any& item, Flow_Control& flow_control) mutable {
+                if constexpr (std::is_void_v<Out>) f(flow_control);
+                else {
+                    Out out = f(flow_control);
+                    if (!flow_control.is_stopped()) item = std::move(out);
+                }
+            };
+        else
+            stage._body = [f = std::move(f)](std::any& item, Flow_Control&) mutable {
+                In in = std::any_cast<In&&>(std::move(item));
+                if constexpr (std::is_void_v<Out>) {
+                    f(std::move(in));
+                    item.reset();
+                }
+                else item = f(std::move(in));
+            };
+        return Filter<In, Out>({ std::move(stage) });
+    }
+
+    template <typename A, typename B, typename C>
+    Filter<A, C> operator&(Filter<A, B> lhs, Filter<B, C> rhs) {
+        for (auto& stage : rhs._stages) lhs._stages.push_back(std::move(stage));
+        return Filter<A, C>(std::move(lhs._stages));
+    }
+
+    template <typename Executor, unsigned char Token_Count_As_Pow2>
+    class Pipeline_Run : public std::enable_shared_from_this<Pipeline_Run<Executor, Token_Count_As_Pow2>> {
+        static constexpr std::size_t _TOKEN_CAPACITY = pow2_size<Token_Count_As_Pow2>;
+        static constexpr std::size_t _MASK = _TOKEN_CAPACITY - 1;
+        static constexpr std::uint32_t _NONE = UINT32_MAX;
+
+        using _Queue = queue_LF_ring_MPMC<std::uint32_t, Token_Count_As_Pow2>;
+
+        struct Token {
+            std::any _item;
+            std::uint64_t _sequence{};
+        };
+
+        struct Serial_Gate {
+            std::atomic<bool> _busy{ false };
+            std::atomic<std::uint64_t> _next_seq{ 0 };
+            _Queue _queue;
+            std::atomic<std::uint32_t> _slots[_TOKEN_CAPACITY];
+
+            Serial_Gate() noexcept {
+                for (auto& slot : _slots) slot.store(_NONE, std::memory_order_relaxed);
+            }
+        };
+
+        bool is_in_order(std::size_t stage) const noexcept {
+            return _stages[stage]._mode == Filter_Modes::Serial_In_Order;
+        }
+
+        void deposit(std::size_t stage, std::uint32_t id) {
+            Serial_Gate& gate = *_gates[stage];
+            if (is_in_order(stage))
+                gate._slots[_tokens[id]._sequence & _MASK].store(id, std::memory_order_release);
+            else
+                gate._queue.push(id);
+        }
+
+        bool has_processable(std::size_t stage) const noexcept {
+            Serial_Gate& gate = *_gates[stage];
+            if (is_in_order(stage))
+                return
+                    gate._slots[gate._next_seq.load(std::memory_order_relaxed) & _MASK]
+                        .load(std::memory_order_acquire) != _NONE;
+            return !gate._queue.empty();
+        }
+
+        std::uint32_t take(std::size_t stage) {
+            Serial_Gate& gate = *_gates[stage];
+            if (is_in_order(stage))
+                return
+                    gate._slots[gate._next_seq.load(std::memory_order_relaxed) & _MASK]
+                        .exchange(_NONE, std::memory_order_acquire);
+            const auto id = gate._queue.try_pop();
+            return id ? *id : _NONE;
+        }
+
+        // the gate is held: process a token and release the gate.
+        // returns the processed token (_NONE if no token is processable).
+        std::uint32_t process_locked(std::size_t stage) {
+            Serial_Gate& gate = *_gates[stage];
+            while (true) {
+                const std::uint32_t id = take(stage);
+                if (id != _NONE) {
+                    Flow_Control flow_control;
+                    _stages[stage]._body(_tokens[id]._item, flow_control);
+                    if (is_in_order(stage))
+                        gate._next_seq.fetch_add(1, std::memory_order_relaxed);
+                    release(stage);
+                    return id;
+                }
+                gate._busy.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!has_processable(stage) || gate._busy.exchange(true, std::memory_order_seq_cst))
+                    return _NONE;
+            }
+        }
+
+        // release the gate and hand a processable token over to a new task
+        void release(std::size_t stage) {
+            Serial_Gate& gate = *_gates[stage];
+            gate._busy.store(false, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (has_processable(stage) && !gate._busy.exchange(true, std::memory_order_seq_cst))
+                _executor->submit([self = this->shared_from_this(), stage] {
+                    const std::uint32_t id = self->process_locked(stage);
+                    if (id != _NONE) self->flow(id, stage + 1);
+                });
+        }
+
+        void flow(std::uint32_t id, std::size_t stage) {
+            while (stage < _stages.size()) {
+                if (_stages[stage]._mode == Filter_Modes::Parallel) {
+                    Flow_Control flow_control;
+                    _stages[stage]._body(_tokens[id]._item, flow_control);
+                    ++stage;
+                    continue;
+                }
+                deposit(stage, id);
+                if (_gates[stage]->_busy.exchange(true, std::memory_order_seq_cst)) return;
+                id = process_locked(stage);
+                if (id == _NONE) return;
+                ++stage;
+            }
+            finish(id);
+        }
+
+        void finish(std::uint32_t id) {
+            _tokens[id]._item.reset();
+            _free.push(id);
+            complete_one();
+            run_input();
+        }
+
+        // _pending counts the tokens in flight and the input (until stopped)
+        void complete_one() {
+            if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                _done.store(true, std::memory_order_release);
+                _done.notify_all();
+            }
+        }
+
+        void submit_input() {
+            _executor->submit([self = this->shared_from_this()] { self->run_input(); });
+        }
+
+        void run_input() {
+            Serial_Gate& gate = *_gates[0];
+            if (gate._busy.exchange(true, std::memory_order_seq_cst)) return;
+            while (true) {
+                // Step 1
+                const auto id = _stopped.load(std::memory_order_relaxed) ? std::nullopt : _free.try_pop();
+                if (!id) {
+                    gate._busy.store(false, std::memory_order_seq_cst);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (
+                        _stopped.load(std::memory_order_relaxed) ||
+                        _free.empty() ||
+                        gate._busy.exchange(true, std::memory_order_seq_cst))
+                        return;
+                    continue;
+                }
+
+                // Step 2
+                Flow_Control flow_control;
+                _stages[0]._body(_tokens[*id]._item, flow_control);
+                if (flow_control.is_stopped()) {
+                    _stopped.store(true, std::memory_order_relaxed);
+                    _free.push(*id);
+                    gate._busy.store(false, std::memory_order_seq_cst);
+                    complete_one();
+                    return;
+                }
+                _tokens[*id]._sequence = _sequence++;
+                _pending.fetch_add(1, std::memory_order_relaxed);
+
+                // Step 3
+                gate._busy.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!_free.empty()) submit_input();
+
+                // Step 4
+                flow(*id, 1);
+                return;
+            }
+        }
+
+    public:
+
+        Pipeline_Run(Executor& executor, std::size_t max_tokens, std::vector<Pipeline_Stage> stages)
+            : _executor(&executor),
+              _stages(std::move(stages)),
+              _tokens(std::make_unique<Token[]>(_TOKEN_CAPACITY))
+        {
+            for (std::size_t i = 0; i < _stages.size(); ++i)
+                _gates.push_back(
+                    _stages[i]._mode == Filter_Modes::Parallel && i
+                        ? nullptr
+                        : std::make_unique<Serial_Gate>());
+            for (std::uint32_t i = 0; i < max_tokens && i < _TOKEN_CAPACITY; ++i)
+                _free.push(i);
+        }
+
+        // run the pipeline and wait for the completion
+        void run() {
+            submit_input();
+            while (!_done.load(std::memory_order_acquire))
+                _done.wait(false, std::memory_order_acquire);
+        }
+
+    private:
+
+        // MEMBERS:
+        // _sequence is accessed by the input gate holder only.
+        Executor* const _executor;
+        const std::vector<Pipeline_Stage> _stages;
+        std::vector<std::unique_ptr<Serial_Gate>> _gates;
+        std::unique_ptr<Token[]> _tokens;
+        _Queue _free;
+        std::atomic<bool> _stopped{ false };
+        std::uint64_t _sequence{};
+        std::atomic<std::size_t> _pending{ 1 };
+        std::atomic<bool> _done{ false };
+    };
+
+    // run the filter chain on the executor with at most max_tokens items in flight
+    // (max_tokens is clamped to pow2_size<Token_Count_As_Pow2>).
+    // returns when the input is stopped and all items are completed.
+    template <unsigned char Token_Count_As_Pow2 = 6, typename Executor>
+    void parallel_pipeline(Executor& executor, std::size_t max_tokens, const Filter<void, void>& chain) {
+        if (chain._stages.empty() || max_tokens == 0) return;
+        auto run = std::make_shared<Pipeline_Run<Executor, Token_Count_As_Pow2>>(
+            executor, max_tokens, chain._stages);
+        run->run();
+    }
+} // namespace BA_Concurrency
+
+#endif // PARALLEL_PIPELINE_HPP
@@ -0,0 +1,412 @@
+// Pool_Scheduler.hpp
+//
+// Description:
+//   The sender/receiver (P2300, std::execution) adapters of the thread pools:
+//     Pool_Scheduler<Pool>: the scheduler of a pool (e.g. Thread_Pool__LF::get_scheduler())
+//     schedule()          : the sender completing on a worker of the pool
+//     then(sender, f)     : the sender completing with f(values)
+//     bulk(sender, n, f)  : the sender invoking f(i, values) for i in [0, n) in parallel on the pool
+//                           and completing with the values
+//     sync_wait(sender)   : starts the sender and blocks until its completion
+//   The operation state is the intrusive task:
+//     start() submits a job holding a single pointer to the operation state,
+//     which fits into the small buffer of std::function.
+//     Hence, there is no heap allocation per operation (apart from the own storage of the queue of the pool).
+//   The operation state is immovable and lives in the storage of the caller (e.g. the frame of sync_wait).
+//
+// Requirements:
+// - Pool must provide submit(std::function<void()>) and get_thread_count().
+// - A receiver provides set_value(values...), set_error(std::exception_ptr) and set_stopped() on rvalues.
+// - A sender provides value_type (void or a single type) and connect(receiver) on rvalues.
+// - The sender of bulk must provide get_completion_scheduler() returning a Pool_Scheduler
+//   (e.g. schedule() and then on it).
+//
+// Semantics:
+//   bulk (the customization for the pools, i.e. parallel_for):
+//     1. Split [0, n) into the chunks: min(n, the thread count of the pool)
+//     2. Submit the chunks except the first one to the pool
+//     3. Run the first chunk inline on the completing worker
+//     4. The worker completing the last chunk completes the receiver
+//        (with the first exception thrown by f if any)
+//
+// Notes:
+//   1. GCC 12 does not ship std::execution.
+//      The adapters follow the shape of P2300 with the member functions instead of tag_invoke
+//      so that the migration to std::execution is a renaming.
+//   2. The values are single (void or T) instead of the completion signatures.
+//
+// Cautions:
+//   1. An operation started on a pool shut down never completes.
+//   2. The operation state must outlive its completion (see sync_wait).
+//
+// TODOs:
+//   1. Add the pipe syntax (schedule(sch) | then(f) | bulk(n, g)) and the stop tokens.
+
+#ifndef POOL_SCHEDULER_HPP
+#define POOL_SCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace BA_Concurrency {
+    template <typename Pool>
+    concept Schedulable_Pool = requires(Pool& pool, std::function<void()> job) {
+        pool.submit(std::move(job));
+        { pool.get_thread_count() } -> std::convertible_to<std::size_t>;
+    };
+
+    template <typename Pool>
+    class Pool_Scheduler;
+
+    // the operation state of schedule(): the intrusive task
+    template <typename Pool, typename R>
+    class Schedule_Operation {
+    public:
+
+        Schedule_Operation(Pool& pool, R receiver)
+            : _pool(&pool), _receiver(std::move(receiver)) {}
+
+        // Non-copyable/movable: the submitted job points to the operation state
+        Schedule_Operation(const Schedule_Operation&) = delete;
+        Schedule_Operation& operator=(const Schedule_Operation&) = delete;
+        Schedule_Operation(Schedule_Operation&&) = delete;
+        Schedule_Operation& operator=(Schedule_Operation&&) = delete;
+
+        void start() noexcept {
+            try {
+                _pool->submit([this] { std::move(_receiver).set_value(); });
+            }
+            catch (...) {
+                std::move(_receiver).set_error(std::current_exception());
+            }
+        }
+
+    private:
+
+        // MEMBERS:
+        Pool* const _pool;
+        R _receiver;
+    };
+
+    template <typename Pool>
+    class Schedule_Sender {
+    public:
+        using value_type = void;
+
+        explicit Schedule_Sender(Pool& pool) noexcept : _pool(&pool) {}
+
+        template <typename R>
+        Schedule_Operation<Pool, R> connect(R receiver) && {
+            return Schedule_Operation<Pool, R>(*_pool, std::move(receiver));
+        }
+
+        Pool_Scheduler<Pool> get_completion_scheduler() const noexcept {
+            return Pool_Scheduler<Pool>(*_pool);
+        }
+
+    private:
+
+        // MEMBERS:
+        Pool* _pool;
+    };
+
+    // the pool is constrained on schedule():
+    // the scheduler is named in the body of the pool (i.e. get_scheduler) where the pool is incomplete
+    template <typename Pool>
+    class Pool_Scheduler {
+    public:
+
+        explicit Pool_Scheduler(Pool& pool) noexcept : _pool(&pool) {}
+
+        Schedule_Sender<Pool> schedule() const noexcept requires Schedulable_Pool<Pool> {
+            return Schedule_Sender<Pool>(*_pool);
+        }
+
+        Pool& pool() const noexcept { return *_pool; }
+
+        friend bool operator==(const Pool_Scheduler&, const Pool_Scheduler&) = default;
+
+    private:
+
+        // MEMBERS:
+        Pool* _pool;
+    };
+
+    // the value type of f invoked on the values of type V (V = void: no value)
+    template <typename F, typename V>
+    struct Invoke_Result { using type = std::invoke_result_t<F, V>; };
+    template <typename F>
+    struct Invoke_Result<F, void> { using type = std::invoke_result_t<F>; };
+
+    // then ------------------------------------------------------------------------------------
+
+    template <typename R, typename F>
+    struct Then_Receiver {
+        R _receiver;
+        F _f;
+
+        template <typename... Vs>
+        void set_value(Vs&&... values) && noexcept {
+            try {
+                if constexpr (std::is_void_v<std::invoke_result_t<F, Vs...>>) {
+                    std::invoke(_f, std::forward<Vs>(values)...);
+                    std::move(_receiver).set_value();
+                }
+                else
+                    std::move(_receiver).set_value(std::invoke(_f, std::forward<Vs>(values)...));
+            }
+            catch (...) {
+                std::move(_receiver).set_error(std::current_exception());
+            }
+        }
+
+        void set_error(std::exception_ptr error) && noexcept { std::move(_receiver).set_error(error); }
+        void set_stopped() && noexcept { std::move(_receiver).set_stopped(); }
+    };
+
+    template <typename S, typename F>
+    class Then_Sender {
+    public:
+        using value_type = typename Invoke_Result<F, typename S::value_type>::type;
+
+        Then_Sender(S sender, F f) : _sender(std::move(sender)), _f(std::move(f)) {}
+
+        template <typename R>
+        auto connect(R receiver) && {
+            return std::move(_sender).connect(Then_Receiver<R, F>{ std::move(receiver), std::move(_f) });
+        }
+
+        auto get_completion_scheduler() const noexcept
+            requires requires(const S& s) { s.get_completion_scheduler(); }
+        {
+            return _sender.get_completion_scheduler();
+        }
+
+    private:
+
+        // MEMBERS:
+        S _sender;
+        F _f;
+    };
+
+    template <typename S, typename F>
+    Then_Sender<S, F> then(S sender, F f) {
+        return Then_Sender<S, F>(std::move(sender), std::move(f));
+    }
+
+    // bulk ------------------------------------------------------------------------------------
+
+    template <typename S, typename F, typename R, typename Pool>
+    class Bulk_Operation {
+        using value_type = typename S::value_type;
+        using stored_t = std::conditional_t<std::is_void_v<value_type>, bool, value_type>;
+
+        struct Bulk_Receiver {
+            Bulk_Operation* _operation;
+
+            template <typename... Vs>
+            void set_value(Vs&&... values) && noexcept {
+                _operation->run(std::forward<Vs>(values)...);
+            }
+
+            void set_error(std::exception_ptr error) && noexcept {
+                std::move(_operation->_receiver).set_error(error);
+            }
+
+            void set_stopped() && noexcept {
+                std::move(_operation->_receiver).set_stopped();
+            }
+        };
+
+        using inner_t = decltype(std::declval<S>().connect(std::declval<Bulk_Receiver>()));
+
+        // Steps 1 to 3 (on the worker completing the sender)
+        template <typename... Vs>
+        void run(Vs&&... values) noexcept {
+            if constexpr (sizeof...(Vs) == 0) _value.emplace(true);
+            else _value.emplace(std::forward<Vs>(values)...);
+            if (_shape == 0) { complete(); return; }
+
+            // Step 1
+            _chunk_count = std::min(_shape, std::max<std::size_t>(_pool->get_thread_count(), 1));
+            _remaining.store(_chunk_count, std::memory_order_relaxed);
+
+            // Step 2: the chunks failing to submit run inline
+            for (std::size_t chunk = 1; chunk < _chunk_count; ++chunk) {
+                try {
+                    _pool->submit([this, chunk] { run_chunk(chunk); });
+                }
+                catch (...) {
+                    run_chunk(chunk);
+                }
+            }
+
+            // Step 3
+            run_chunk(0);
+        }
+
+        void run_chunk(std::size_t chunk) noexcept {
+            const std::size_t first = chunk * _shape / _chunk_count;
+            const std::size_t last = (chunk + 1) * _shape / _chunk_count;
+            for (std::size_t i = first; i < last && !_failed.load(std::memory_order_relaxed); ++i) {
+                try {
+                    if constexpr (std::is_void_v<value_type>) std::invoke(_f, i);
+                    else std::invoke(_f, i, *_value);
+                }
+                catch (...) {
+                    if (!_failed.exchange(true, std::memory_order_relaxed))
+                        _error = std::current_exception();
+                }
+            }
+
+            // Step 4
+            if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) complete();
+        }
+
+        void complete() noexcept {
+            if (_failed.load(std::memory_order_relaxed))
+                std::move(_receiver).set_error(_error);
+            else if constexpr (std::is_void_v<value_type>)
+                std::move(_receiver).set_value();
+            else
+                std::move(_receiver).set_value(std::move(*_value));
+        }
+
+    public:
+
+        Bulk_Operation(S&& sender, Pool& pool, std::size_t shape, F&& f, R&& receiver)
+            : _pool(&pool),
+              _shape(shape),
+              _f(std::move(f)),
+              _receiver(std::move(receiver)),
+              _inner(std::move(sender).connect(Bulk_Receiver{ this })) {}
+
+        // Non-copyable/movable: the receiver and the chunks point to the operation state
+        Bulk_Operation(const Bulk_Operation&) = delete;
+        Bulk_Operation& operator=(const Bulk_Operation&) = delete;
+        Bulk_Operation(Bulk_Operation&&) = delete;
+        Bulk_Operation& operator=(Bulk_Operation&&) = delete;
+
+        void start() noexcept { _inner.start(); }
+
+    private:
+
+        // MEMBERS:
+        // _error is published by the release of _remaining and acquired by the completing worker.
+        Pool* const _pool;
+        const std::size_t _shape;
+        std::size_t _chunk_count{};
+        F _f;
+        R _receiver;
+        std::optional<stored_t> _value;
+        std::atomic<std::size_t> _remaining{ 0 };
+        std::atomic<bool> _failed{ false };
+        std::exception_ptr _error;
+        inner_t _inner;
+    };
+
+    template <typename S, typename F>
+    class Bulk_Sender {
+        using pool_t = std::remove_reference_t<
+            decltype(std::declval<const S&>().get_completion_scheduler().pool())>;
+
+    public:
+        using value_type = typename S::value_type;
+
+        Bulk_Sender(S sender, std::size_t shape, F f)
+            : _sender(std::move(sender)), _shape(shape), _f(std::move(f)) {}
+
+        template <typename R>
+        Bulk_Operation<S, F, R, pool_t> connect(R receiver) && {
+            pool_t& pool = _sender.get_completion_scheduler().pool();
+            return Bulk_Operation<S, F, R, pool_t>(
+                std::move(_sender), pool, _shape, std::move(_f), std::move(receiver));
+        }
+
+        auto get_completion_scheduler() const noexcept {
+            return _sender.get_completion_scheduler();
+        }
+
+    private:
+
+        // MEMBERS:
+        S _sender;
+        std::size_t _shape;
+        F _f;
+    };
+
+    template <typename S, typename F>
+    requires requires(const S& s) { s.get_completion_scheduler().pool(); }
+    Bulk_Sender<S, F> bulk(S sender, std::size_t shape, F f) {
+        return Bulk_Sender<S, F>(std::move(sender), shape, std::move(f));
+    }
+
+    // sync_wait -------------------------------------------------------------------------------
+
+    template <typename V>
+    struct Sync_Wait_State {
+        using stored_t = std::conditional_t<std::is_void_v<V>, bool, V>;
+        std::optional<stored_t> _value;
+        std::exception_ptr _error;
+        bool _done{ false };
+        std::mutex _m;
+        std::condition_variable _cv;
+    };
+
+    template <typename V>
+    struct Sync_Wait_Receiver {
+        Sync_Wait_State<V>* _state;
+
+        template <typename... Vs>
+        void set_value(Vs&&... values) && noexcept {
+            if constexpr (sizeof...(Vs) == 0) _state->_value.emplace(true);
+            else _state->_value.emplace(std::forward<Vs>(values)...);
+            done();
+        }
+
+        void set_error(std::exception_ptr error) && noexcept {
+            _state->_error = error;
+            done();
+        }
+
+        void set_stopped() && noexcept { done(); }
+
+        // notifies under the lock:
+        // sync_wait cannot destroy the state before the notification completes
+        void done() noexcept {
+            std::scoped_lock lk(_state->_m);
+            _state->_done = true;
+            _state->_cv.notify_one();
+        }
+    };
+
+    // starts the sender and blocks until its completion:
+    //   value  : returns the value (true for void)
+    //   error  : rethrows the exception
+    //   stopped: returns std::nullopt (false for void)
+    template <typename S>
+    auto sync_wait(S sender) {
+        using V = typename S::value_type;
+        Sync_Wait_State<V> state;
+        auto operation = std::move(sender).connect(Sync_Wait_Receiver<V>{ &state });
+        operation.start();
+        {
+            std::unique_lock lk(state._m);
+            state._cv.wait(lk, [&] { return state._done; });
+        }
+        if (state._error) std::rethrow_exception(state._error);
+        if constexpr (std::is_void_v<V>) return state._value.has_value();
+        else return std::move(state._value);
+    }
+} // namespace BA_Concurrency
+
+#endif // POOL_SCHEDULER_HPP
@@ -0,0 +1,132 @@
+// Queue_Monitor.hpp
+//
+// Description:
+//   The depth monitor of a queue for the autoscalers, the load balancers and the backpressure:
+//     1. The high and the low watermarks of the queue depth.
+//     2. The callbacks fired on the crossings of the watermarks only (not on each operation):
+//          on_high: the depth reached the high watermark (e.g. add workers, reject the producers)
+//          on_low : the depth dropped to the low watermark after a high crossing (e.g. release)
+//   The gap between the watermarks is the hysteresis preventing the flapping of the signals.
+//   A queue supporting the monitoring (e.g. queue_LF_ring_MPMC) takes the monitor in its constructor,
+//   reports the approximate depth after each push and pop
+//   and stores the push timestamps in its slots for oldest_item_age.
+//
+// Requirements:
+// - low_watermark < high_watermark
+// - The callbacks must not throw.
+//
+// Semantics:
+//   observe(depth):
+//     1. Load the state (above the high watermark or not)
+//     2. Return if the depth does not cross the watermark of the state (the common path)
+//     3. CAS the state: the winner fires the callback
+//   Hence, the high and the low crossings alternate and each crossing fires once.
+//
+// Progress:
+//   observe is lock-free (excluding the callbacks).
+//
+// Notes:
+//   1. The depth is approximate (see approximate_size of the queues):
+//      the crossings follow the observed depths, not the exact depths.
+//
+// Cautions:
+//   1. The callbacks run on the producer and the consumer threads.
+//      Keep them short (e.g. set a flag or notify a controller).
+//   2. The high and the low callbacks of the consecutive crossings may run concurrently.
+//   3. The monitor must outlive the queue.
+
+#ifndef QUEUE_MONITOR_HPP
+#define QUEUE_MONITOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace BA_Concurrency {
+    class Queue_Monitor {
+    public:
+        using callback_t = std::function<void(std::size_t depth)>;
+        using clock_t = std::chrono::steady_clock;
+
+        Queue_Monitor(
+            std::size_t low_watermark,
+            std::size_t high_watermark,
+            callback_t on_high,
+            callback_t on_low = {})
+                : _low(low_watermark),
+                  _high(high_watermark),
+                  _on_high(std::move(on_high)),
+                  _on_low(std::move(on_low))
+        {
+            if (low_watermark >= high_watermark)
+                throw std::invalid_argument("Queue_Monitor: low_watermark must be less than high_watermark");
+        }
+
+        // Non-copyable/movable for simplicity
+        Queue_Monitor(const Queue_Monitor&) = delete;
+        Queue_Monitor& operator=(const Queue_Monitor&) = delete;
+        Queue_Monitor(Queue_Monitor&&) = delete;
+        Queue_Monitor& operator=(Queue_Monitor&&) = delete;
+
+        // 1. Load the state
+        // 2. Return if the depth does not cross the watermark of the state
+        // 3. CAS the state: the winner fires the callback
+        void observe(std::size_t depth) noexcept {
+            // Step 1
+            bool above = _above.load(std::memory_order_relaxed);
+
+            // Step 2
+            if (above ? depth > _low : depth < _high) return;
+
+            // Step 3
+            if (!_above.compare_exchange_strong(
+                    above, !above, std::memory_order_acq_rel, std::memory_order_relaxed)) return;
+            if (above) { if (_on_low) _on_low(depth); }
+            else if (_on_high) _on_high(depth);
+        }
+
+        // true after a high crossing until the next low crossing
+        bool is_above_high_watermark() const noexcept {
+            return _above.load(std::memory_order_relaxed);
+        }
+
+        std::size_t low_watermark() const noexcept { return _low; }
+        std::size_t high_watermark() const noexcept { return _high; }
+
+        // the timestamp stored into the slots by the queues (see oldest_item_age)
+        static std::int64_t now() noexcept {
+            return clock_t::now().time_since_epoch().count();
+        }
+
+        // the age of an item pushed at the timestamp (zero for a timestamp in the future)
+        static std::chrono::nanoseconds age(std::int64_t timestamp) noexcept {
+            const auto elapsed = clock_t::duration(now() - timestamp);
+            return elapsed.count() > 0
+                ? std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                : std::chrono::nanoseconds::zero();
+        }
+
+        // the depth of a ticket-based queue:
+        // clamped as the tickets of the waiting producers and consumers run ahead
+        static std::size_t depth(std::size_t head, std::size_t tail, std::size_t capacity) noexcept {
+            if (tail <= head) return 0;
+            return tail - head < capacity ? tail - head : capacity;
+        }
+
+    private:
+
+        // MEMBERS:
+        // _above is written on the crossings only (read-mostly on the common path).
+        const std::size_t _low;
+        const std::size_t _high;
+        const callback_t _on_high;
+        const callback_t _on_low;
+        std::atomic<bool> _above{ false };
+    };
+} // namespace BA_Concurrency
+
+#endif // QUEUE_MONITOR_HPP
@@ -0,0 +1,317 @@
+// Rcu_Ptr.hpp
+//
+// Description:
+//   A lock-free atomic shared pointer with the split reference counting
+//   for publishing the immutable snapshots (e.g. the configuration and the hot-reload paths):
+//     std::atomic<std::shared_ptr<T>> is implemented with a lock by libstdc++.
+//     Rcu_Ptr<T> replaces it with a single-word CAS loop for the readers.
+//
+//   Rcu_Ref<T>: the reference counted handle of an immutable snapshot (an intrusive shared pointer)
+//   Rcu_Ptr<T>: the atomic holder of an Rcu_Ref<T>
+//     load                  : returns an Rcu_Ref<T> of the current snapshot (lock-free)
+//     store                 : publishes a new snapshot (lock-free)
+//     exchange              : publishes a new snapshot and returns the old one (lock-free)
+//     compare_exchange_strong: publishes a new snapshot if the current one is the expected (lock-free)
+//
+// Requirements:
+// - The platform must use 48-bit user space addresses (x86-64, AArch64).
+//
+// Design:
+//   The word of Rcu_Ptr packs {ptr, local count}:
+//     bits  0-47: the ptr to the node (the snapshot and its reference count)
+//     bits 48-63: the local count: the number of the references borrowed by the readers
+//   The split reference counting:
+//     The node count (the global count) is charged with a batch of references
+//     (_BATCH) when the node is published.
+//     A reader borrows one of the charged references by incrementing the local count
+//     (a single CAS on the word) and owns the reference afterwards.
+//     Hence, the readers never write the node count on load.
+//     When the node is replaced, the unused part of the batch (_BATCH - local count)
+//     is subtracted from the node count.
+//   The refill:
+//     A reader which brings the local count to _REFILL charges the node count with _REFILL more references
+//     and subtracts _REFILL from the local count.
+//     If the node is replaced in the meantime, the reader takes the surplus charge back.
+//     The refill is independent of the publication of the node:
+//     the charge and the local count are modified by the same amount for the same node.
+//     Hence, a node published again (ABA) is accounted correctly.
+//
+// Semantics:
+//   load:
+//     1. Increment the local count by CAS
+//     2. If the local count reaches _REFILL, refill the batch
+//     3. Return an Rcu_Ref<T> owning the borrowed reference
+//   exchange(desired):
+//     1. Charge the desired node with the batch (the desired Rcu_Ref is consumed)
+//     2. Replace the word by CAS
+//     3. Subtract the unused part of the batch from the old node
+//        keeping a reference for the returned Rcu_Ref<T>
+//
+// Progress:
+//   Lock-free
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release a snapshot before publishing it and
+//      to acquire a snapshot after loading it.
+//      The last release of a node acquires all preceding releases (acq_rel decrement).
+//   2. The snapshots are immutable: Rcu_Ref<T> gives const access only.
+//
+// Cautions:
+//   1. The local count is bounded by the batch (the borrowed references never exceed the charge).
+//      A reader finding the batch exhausted (a refill is pending) yields and retries.
+//   2. compare_exchange_strong compares the ptrs only (like std::atomic<std::shared_ptr<T>>).
+//
+// TODOs:
+//   1. Consider the aliasing constructor of std::shared_ptr (Rcu_Ref to a member of the snapshot).
+
+#ifndef RCU_PTR_HPP
+#define RCU_PTR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <type_traits>
+
+namespace BA_Concurrency {
+    template <typename T>
+    class Rcu_Ptr;
+
+    // the node: the snapshot and the global reference count
+    template <typename T>
+    struct Rcu_Node {
+        std::atomic<std::int64_t> _count;
+        const T _value;
+
+        template <typename... Args>
+        explicit Rcu_Node(Args&&... args)
+            : _count(1), _value(std::forward<Args>(args)...) {}
+
+        // returns true if the node is deleted
+        static bool release(Rcu_Node* node, std::int64_t count) noexcept {
+            if (node->_count.fetch_sub(count, std::memory_order_acq_rel) != count)
+                return false;
+            delete node;
+            return true;
+        }
+    };
+
+    // the reference counted handle of an immutable snapshot
+    template <typename T>
+    class Rcu_Ref {
+        friend class Rcu_Ptr<T>;
+
+        template <typename U, typename... Args>
+        friend Rcu_Ref<U> make_rcu(Args&&... args);
+
+        // adopt a reference owned by the caller
+        explicit Rcu_Ref(Rcu_Node<T>* node) noexcept : _node(node) {}
+
+    public:
+
+        Rcu_Ref() noexcept = default;
+        Rcu_Ref(std::nullptr_t) noexcept {}
+
+        ~Rcu_Ref() {
+            if (_node) Rcu_Node<T>::release(_node, 1);
+        }
+
+        Rcu_Ref(const Rcu_Ref& rhs) noexcept : _node(rhs._node) {
+            if (_node) _node->_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        Rcu_Ref& operator=(const Rcu_Ref& rhs) noexcept {
+            Rcu_Ref(rhs).swap(*this);
+            return *this;
+        }
+        Rcu_Ref(Rcu_Ref&& rhs) noexcept : _node(std::exchange(rhs._node, nullptr)) {}
+        Rcu_Ref& operator=(Rcu_Ref&& rhs) noexcept {
+            Rcu_Ref(std::move(rhs)).swap(*this);
+            return *this;
+        }
+
+        void swap(Rcu_Ref& rhs) noexcept {
+            std::swap(_node, rhs._node);
+        }
+
+        void reset() noexcept {
+            Rcu_Ref().swap(*this);
+        }
+
+        const T* get() const noexcept {
+            return _node ? &_node->_value : nullptr;
+        }
+        const T& operator*() const noexcept {
+            return _node->_value;
+        }
+        const T* operator->() const noexcept {
+            return &_node->_value;
+        }
+        explicit operator bool() const noexcept {
+            return _node != nullptr;
+        }
+
+        friend bool operator==(const Rcu_Ref& lhs, const Rcu_Ref& rhs) noexcept {
+            return lhs._node == rhs._node;
+        }
+
+    private:
+
+        // MEMBERS:
+        Rcu_Node<T>* _node{};
+    };
+
+    template <typename T, typename... Args>
+    Rcu_Ref<T> make_rcu(Args&&... args) {
+        return Rcu_Ref<T>(new Rcu_Node<T>(std::forward<Args>(args)...));
+    }
+
+    // the atomic holder of an Rcu_Ref
+    template <typename T>
+    class Rcu_Ptr {
+        static_assert(sizeof(void*) == 8, "Rcu_Ptr requires 64-bit ptrs");
+
+        static constexpr std::uint64_t _PTR_MASK = (std::uint64_t{ 1 } << 48) - 1;
+        static constexpr std::uint64_t _LOCAL_ONE = std::uint64_t{ 1 } << 48;
+        static constexpr std::int64_t _BATCH = std::int64_t{ 1 } << 15;
+        static constexpr std::uint64_t _REFILL = std::uint64_t{ 1 } << 14;
+
+        static Rcu_Node<T>* to_node(std::uint64_t word) noexcept {
+            return reinterpret_cast<Rcu_Node<T>*>(word & _PTR_MASK);
+        }
+        static std::uint64_t to_local(std::uint64_t word) noexcept {
+            return word >> 48;
+        }
+        static std::uint64_t to_word(Rcu_Node<T>* node) noexcept {
+            return reinterpret_cast<std::uint64_t>(node);
+        }
+
+        // Step 1 of exchange: consume the desired ref and charge its node with the batch
+        static std::uint64_t charge(Rcu_Ref<T>&& desired) noexcept {
+            Rcu_Node<T>* node = std::exchange(desired._node, nullptr);
+            if (node) node->_count.fetch_add(_BATCH - 1, std::memory_order_relaxed);
+            return to_word(node);
+        }
+
+        // Step 3 of exchange: subtract the unused part of the batch keeping a reference
+        static Rcu_Ref<T> discharge(std::uint64_t word) noexcept {
+            Rcu_Node<T>* node = to_node(word);
+            if (node) {
+                const std::int64_t unused = _BATCH - static_cast<std::int64_t>(to_local(word));
+                node->_count.fetch_sub(unused - 1, std::memory_order_relaxed);
+            }
+            return Rcu_Ref<T>(node);
+        }
+
+        // Step 2 of load: move _REFILL references from the node count into the local count
+        void refill(Rcu_Node<T>* node) const noexcept {
+            node->_count.fetch_add(_REFILL, std::memory_order_relaxed);
+            std::uint64_t word = _word.load(std::memory_order_relaxed);
+            while (to_node(word) == node && to_local(word) >= _REFILL)
+                if (
+                    _word.compare_exchange_weak(
+                        word,
+                        word - _REFILL * _LOCAL_ONE,
+                        std::memory_order_relaxed,
+                        std::memory_order_relaxed))
+                    return;
+
+            // replaced or refilled by another reader: take the surplus back
+            // (the node is alive as this reader owns a reference)
+            node->_count.fetch_sub(_REFILL, std::memory_order_relaxed);
+        }
+
+    public:
+
+        Rcu_Ptr() noexcept = default;
+        explicit Rcu_Ptr(Rcu_Ref<T> desired) noexcept : _word(charge(std::move(desired))) {}
+
+        // Single-threaded context expected.
+        ~Rcu_Ptr() {
+            discharge(_word.load(std::memory_order_acquire));
+        }
+
+        // Non-copyable/movable for simplicity
+        Rcu_Ptr(const Rcu_Ptr&) = delete;
+        Rcu_Ptr& operator=(const Rcu_Ptr&) = delete;
+        Rcu_Ptr(Rcu_Ptr&&) = delete;
+        Rcu_Ptr& operator=(Rcu_Ptr&&) = delete;
+
+        Rcu_Ref<T> load() const noexcept {
+            // Step 1
+            std::uint64_t word = _word.load(std::memory_order_acquire);
+            while (true) {
+                if (!to_node(word)) return Rcu_Ref<T>();
+                if (to_local(word) >= static_cast<std::uint64_t>(_BATCH)) {
+                    std::this_thread::yield();
+                    word = _word.load(std::memory_order_acquire);
+                    continue;
+                }
+                if (
+                    _word.compare_exchange_weak(
+                        word,
+                        word + _LOCAL_ONE,
+                        std::memory_order_acquire,
+                        std::memory_order_acquire))
+                    break;
+            }
+
+            // Step 2
+            Rcu_Node<T>* node = to_node(word);
+            if (to_local(word) + 1 == _REFILL) refill(node);
+
+            // Step 3
+            return Rcu_Ref<T>(node);
+        }
+
+        Rcu_Ref<T> exchange(Rcu_Ref<T> desired) noexcept {
+            // Steps 1 and 2
+            const std::uint64_t old_word = _word.exchange(charge(std::move(desired)), std::memory_order_acq_rel);
+
+            // Step 3
+            return discharge(old_word);
+        }
+
+        void store(Rcu_Ref<T> desired) noexcept {
+            exchange(std::move(desired));
+        }
+
+        // compares the ptrs only.
+        // on failure, expected is replaced with the current snapshot.
+        bool compare_exchange_strong(Rcu_Ref<T>& expected, Rcu_Ref<T> desired) noexcept {
+            const std::uint64_t desired_word = charge(std::move(desired));
+            std::uint64_t word = _word.load(std::memory_order_relaxed);
+            while (to_node(word) == expected._node) {
+                if (
+                    _word.compare_exchange_weak(
+                        word,
+                        desired_word,
+                        std::memory_order_acq_rel,
+                        std::memory_order_relaxed))
+                {
+                    discharge(word);
+                    return true;
+                }
+            }
+
+            // failed: release the charge of the desired node
+            if (Rcu_Node<T>* node = to_node(desired_word))
+                Rcu_Node<T>::release(node, _BATCH);
+            expected = load();
+            return false;
+        }
+
+        // returns true if ref is the current snapshot (no reference is taken)
+        bool is(const Rcu_Ref<T>& ref) const noexcept {
+            return to_node(_word.load(std::memory_order_acquire)) == ref._node;
+        }
+
+    private:
+
+        // MEMBERS:
+        mutable std::atomic<std::uint64_t> _word{};
+    };
+} // namespace BA_Concurrency
+
+#endif // RCU_PTR_HPP
@@ -0,0 +1,318 @@
+// Reactor.hpp
+//
+// Description:
+//   The epoll reactor (Linux) dispatching the readiness callbacks of the file descriptors
+//   (e.g. the pipes, the sockets, the timerfds and the eventfds).
+//   Two modes:
+//     pool mode  : the callbacks are submitted onto a thread pool (IThread_Pool).
+//     inline mode: the callbacks run on the reactor thread.
+//   In both modes, the jobs posted to the reactor (post) run on the reactor thread.
+//   The posted jobs are queued by Concurrent_Queue__Blocking_Eventfd whose eventfd is registered to the epoll.
+//   Hence, the reactor thread sleeps at a single point (epoll_wait) for the I/O, the timers and the jobs
+//   and a cross-thread wake-up costs an eventfd write instead of a condition variable and a thread hop.
+//
+// Requirements:
+// - Linux (epoll, eventfd and timerfd).
+// - The pool (if any) must outlive the reactor and must not drop the submitted jobs
+//   (e.g. the rejection of Thread_Pool__Blocking with CoDel).
+// - The callbacks and the posted jobs must not throw.
+//
+// Design:
+//   A registration (Handler) is identified by a unique id stored in the epoll data
+//   so that a stale event of a removed registration is skipped (even if the fd is reused).
+//   pool mode:
+//     The registrations are armed with EPOLLONESHOT.
+//     The reactor thread disarms the registration and submits the callback onto the pool.
+//     The pool job runs the callback and rearms the registration (unless removed).
+//     Hence, the callbacks of a file descriptor never run concurrently.
+//   inline mode:
+//     The registrations are level-triggered (no rearm syscall).
+//   The registry (and the in-flight count) is guarded by _m.
+//
+// Semantics:
+//   reactor thread:
+//     1. Wait for the events (epoll_wait)
+//     2. Run the posted jobs or dispatch the callbacks of the ready registrations
+//     3. Exit if stopping
+//   add(fd, events, callback, owns_fd):
+//     owns_fd = true hands the fd over to the reactor:
+//     the fd is closed when the registration is removed and its callback is not in flight.
+//   add_timer: a periodic timerfd owned by the reactor. The callback receives the expiration count.
+//   The destructor runs the remaining posted jobs and waits for the callbacks in flight.
+//
+// Progress:
+//   Blocking
+//
+// Cautions:
+//   1. pool mode: a callback in flight may still run once after remove returns.
+//      Use owns_fd (or close the fd in the callback) instead of closing it right after remove.
+//   2. The callbacks must consume the readiness (e.g. read the pipe) or they are dispatched again.
+//
+// TODOs:
+//   1. Consider the idle workers of the pools polling the epoll (leader/followers) instead of a reactor thread.
+
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "IThread_Pool.hpp"
+#include "Concurrent_Queue__Blocking_Eventfd.hpp"
+
+namespace BA_Concurrency {
+    class Reactor {
+        using callback_t = std::function<void(std::uint32_t)>;
+        using job_t = std::function<void()>;
+        static constexpr std::uint64_t _POSTED = 0;
+        static constexpr int _MAX_EVENTS = 64;
+
+        struct Handler {
+            int _fd;
+            std::uint64_t _id;
+            std::uint32_t _events;
+            callback_t _callback;
+            bool _owns_fd;
+            bool _active{ true }; // guarded by _m
+            bool _armed{ true };  // guarded by _m
+
+            ~Handler() {
+                if (_owns_fd) ::close(_fd);
+            }
+        };
+
+        [[noreturn]] static void fail(int error, const char* what) {
+            throw std::system_error(error, std::generic_category(), what);
+        }
+
+        // the lock is held
+        int control(int operation, const Handler& handler) noexcept {
+            epoll_event event{};
+            event.events = handler._events | (_pool ? EPOLLONESHOT : 0u);
+            event.data.u64 = handler._id;
+            return ::epoll_ctl(_epoll_fd, operation, handler._fd, &event);
+        }
+
+        // the pool job completed the callback: rearm and release the in-flight count
+        void finish(Handler& handler) noexcept {
+            std::scoped_lock lk(_m);
+            if (handler._active) {
+                handler._armed = true;
+                control(EPOLL_CTL_MOD, handler);
+            }
+            if (--_in_flight == 0) _idle.notify_all();
+        }
+
+        void dispatch(std::uint64_t id, std::uint32_t events) {
+            std::shared_ptr<Handler> handler;
+            {
+                std::scoped_lock lk(_m);
+                auto it = _handlers.find(id);
+                if (it == _handlers.end()) return; // a stale event of a removed registration
+                handler = it->second;
+                if (_pool) {
+                    handler->_armed = false;
+                    ++_in_flight;
+                }
+            }
+
+            if (!_pool) {
+                handler->_callback(events);
+                return;
+            }
+            try {
+                _pool->submit([this, handler, events] {
+                    handler->_callback(events);
+                    finish(*handler);
+                });
+            }
+            catch (...) {
+                // the pool cannot queue the callback: run inline
+                handler->_callback(events);
+                finish(*handler);
+            }
+        }
+
+        void run_posted() {
+            while (auto job = _posted.try_pop()) (*job)();
+        }
+
+        void loop() {
+            epoll_event events[_MAX_EVENTS];
+            while (true) {
+                // Step 1
+                const int count = ::epoll_wait(_epoll_fd, events, _MAX_EVENTS, -1);
+                if (count < 0) {
+                    if (errno != EINTR) std::this_thread::yield();
+                    continue;
+                }
+
+                // Step 2
+                for (int i = 0; i < count; ++i) {
+                    if (events[i].data.u64 == _POSTED) run_posted();
+                    else dispatch(events[i].data.u64, events[i].events);
+                }
+
+                // Step 3
+                if (_posted.is_closed()) {
+                    run_posted();
+                    return;
+                }
+            }
+        }
+
+        void start() {
+            if (_epoll_fd < 0) fail(errno, "Reactor: epoll_create1");
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = _POSTED;
+            if (::epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _posted.native_handle(), &event) < 0) {
+                const int error = errno;
+                ::close(_epoll_fd);
+                fail(error, "Reactor: epoll_ctl");
+            }
+            _thread = std::thread([this] { loop(); });
+        }
+
+    public:
+
+        // inline mode: the callbacks run on the reactor thread
+        // throws std::system_error if the epoll cannot be created
+        Reactor() : _pool(nullptr), _epoll_fd(::epoll_create1(EPOLL_CLOEXEC)) {
+            start();
+        }
+
+        // pool mode: the callbacks are submitted onto the pool
+        explicit Reactor(IThread_Pool& pool) : _pool(&pool), _epoll_fd(::epoll_create1(EPOLL_CLOEXEC)) {
+            start();
+        }
+
+        // Single-threaded context expected (no concurrent add or post).
+        // Runs the remaining posted jobs and waits for the callbacks in flight.
+        ~Reactor() {
+            _posted.close();
+            _thread.join();
+            {
+                std::unique_lock lk(_m);
+                _idle.wait(lk, [&] { return _in_flight == 0; });
+                for (auto& [id, handler] : _handlers) handler->_active = false;
+            }
+            _handlers.clear();
+            _ids.clear();
+            ::close(_epoll_fd);
+        }
+
+        // Non-copyable/movable for simplicity
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+        Reactor(Reactor&&) = delete;
+        Reactor& operator=(Reactor&&) = delete;
+
+        // events: the epoll events (e.g. EPOLLIN). the callback receives the ready events.
+        // owns_fd: the reactor closes the fd when the registration is removed (or add fails).
+        // throws std::system_error if epoll_ctl fails (e.g. EEXIST if the fd is already registered)
+        void add(int fd, std::uint32_t events, callback_t callback, bool owns_fd = false) {
+            // no temporary Handler: its destructor would close the owned fd
+            std::shared_ptr<Handler> handler(new Handler{ fd, 0, events, std::move(callback), owns_fd });
+            std::scoped_lock lk(_m);
+            handler->_id = ++_next_id;
+            if (control(EPOLL_CTL_ADD, *handler) < 0) fail(errno, "Reactor: epoll_ctl");
+            _ids.emplace(fd, handler->_id);
+            _handlers.emplace(handler->_id, std::move(handler));
+        }
+
+        // pool mode: an in-flight callback applies the new events when it completes
+        void modify(int fd, std::uint32_t events) {
+            std::scoped_lock lk(_m);
+            auto it = _ids.find(fd);
+            if (it == _ids.end()) return;
+            Handler& handler = *_handlers.at(it->second);
+            handler._events = events;
+            if (handler._armed && control(EPOLL_CTL_MOD, handler) < 0) fail(errno, "Reactor: epoll_ctl");
+        }
+
+        // see Cautions 1. returns false if the fd is not registered.
+        bool remove(int fd) {
+            std::shared_ptr<Handler> handler;
+            {
+                std::scoped_lock lk(_m);
+                auto it = _ids.find(fd);
+                if (it == _ids.end()) return false;
+                auto node = _handlers.extract(it->second);
+                _ids.erase(it);
+                handler = std::move(node.mapped());
+                handler->_active = false;
+                ::epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            }
+            return true; // the fd is closed here if owned and not in flight
+        }
+
+        // a periodic CLOCK_MONOTONIC timer (period = 0: a one-shot timer).
+        // the callback receives the expiration count. returns the timerfd (see remove).
+        int add_timer(
+            std::chrono::nanoseconds first,
+            std::chrono::nanoseconds period,
+            std::function<void(std::uint64_t)> callback)
+        {
+            const int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (fd < 0) fail(errno, "Reactor: timerfd_create");
+
+            // an expiration time of zero disarms the timer
+            if (first <= std::chrono::nanoseconds::zero()) first = std::chrono::nanoseconds(1);
+            itimerspec spec{};
+            spec.it_value.tv_sec = first.count() / 1'000'000'000;
+            spec.it_value.tv_nsec = first.count() % 1'000'000'000;
+            spec.it_interval.tv_sec = period.count() / 1'000'000'000;
+            spec.it_interval.tv_nsec = period.count() % 1'000'000'000;
+
+            add(fd, EPOLLIN, [fd, callback = std::move(callback)](std::uint32_t) {
+                std::uint64_t expirations{};
+                if (::read(fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+                    callback(expirations);
+            }, true);
+
+            if (::timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+                const int error = errno;
+                remove(fd);
+                fail(error, "Reactor: timerfd_settime");
+            }
+            return fd;
+        }
+
+        // runs the job on the reactor thread (e.g. to access the state owned by the inline callbacks)
+        void post(job_t job) {
+            _posted.push(std::move(job));
+        }
+
+        bool is_reactor_thread() const noexcept {
+            return std::this_thread::get_id() == _thread.get_id();
+        }
+
+    private:
+
+        // MEMBERS:
+        IThread_Pool* const _pool;
+        const int _epoll_fd;
+        Concurrent_Queue__Blocking_Eventfd<job_t> _posted;
+        std::unordered_map<std::uint64_t, std::shared_ptr<Handler>> _handlers;
+        std::unordered_map<int, std::uint64_t> _ids;
+        std::uint64_t _next_id{ _POSTED };
+        std::size_t _in_flight{ 0 };
+        std::condition_variable _idle;
+        std::mutex _m;
+        std::thread _thread;
+    };
+} // namespace BA_Concurrency
+
+#endif // REACTOR_HPP
@@ -0,0 +1,126 @@
+// Realtime_Config.hpp
+//
+// Description:
+//   The real-time configuration of the pool workers for the lowest-latency paths
+//   (the dedicated busy-polling workers on the isolated cores):
+//     1. The real-time scheduling policy (SCHED_FIFO or SCHED_RR) and the priority.
+//     2. The CPU pinning: worker i is pinned to _cpus[i % _cpus.size()]
+//        (e.g. the cores isolated by the isolcpus or nohz_full kernel parameters).
+//     3. The memory locking: mlock (and hence pre-fault) the queue storage and the top of the worker stacks
+//        so that the hot path never takes a page fault.
+//     4. The busy polling: the idle workers pause-spin (cpu_relax) instead of yielding the core.
+//   Each setting falls back gracefully:
+//     a failing setting (e.g. EPERM without CAP_SYS_NICE or RLIMIT_MEMLOCK) is skipped
+//     and recorded in Realtime_Status.
+//
+// Requirements:
+// - Linux (sched_setscheduler, sched_setaffinity, mlock and pthread_getattr_np).
+// - 1 <= _priority <= 99 for the real-time policies.
+//
+// Notes:
+//   1. mlock faults in the locked range (the pre-fault).
+//   2. The storage allocated by the jobs (e.g. the captures of std::function) is not locked.
+//      Use mlockall(MCL_CURRENT | MCL_FUTURE) for the whole process if required.
+//
+// Cautions:
+//   1. A busy-polling SCHED_FIFO worker never leaves its core.
+//      Never pin it to a core shared with the other threads (e.g. the housekeeping threads):
+//      the real-time throttling of the kernel (sched_rt_runtime_us) is the only rescue.
+
+#ifndef REALTIME_CONFIG_HPP
+#define REALTIME_CONFIG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+namespace BA_Concurrency {
+    enum class Realtime_Policies : unsigned char {
+        None,        // SCHED_OTHER (unchanged)
+        FIFO,        // SCHED_FIFO
+        Round_Robin  // SCHED_RR
+    };
+
+    struct Realtime_Config {
+        Realtime_Policies _policy{ Realtime_Policies::None };
+        int _priority{ 1 };
+        std::vector<int> _cpus{};                          // empty: no pinning
+        bool _lock_memory{ false };                        // the queue storage and the worker stacks
+        std::size_t _stack_lock_bytes{ 256 * 1024 };       // locked from the top of each worker stack
+        bool _busy_poll{ false };                          // pause-spin instead of yield
+    };
+
+    // the settings achieved (the workers failing a setting fall back silently)
+    struct Realtime_Status {
+        std::atomic<std::size_t> _scheduled_workers{ 0 };
+        std::atomic<std::size_t> _pinned_workers{ 0 };
+        std::atomic<std::size_t> _locked_worker_stacks{ 0 };
+        std::atomic<bool> _queue_locked{ false };
+    };
+
+    // the spin-wait hint: releases the pipeline resources to the sibling hyper-thread
+    // without leaving the core (unlike std::this_thread::yield)
+    inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    // sets the real-time policy of the calling thread.
+    // returns false if not permitted (e.g. EPERM without CAP_SYS_NICE).
+    inline bool apply_realtime_policy(Realtime_Policies policy, int priority) noexcept {
+        if (policy == Realtime_Policies::None) return false;
+        sched_param param{};
+        param.sched_priority = priority;
+        return pthread_setschedparam(
+            pthread_self(),
+            policy == Realtime_Policies::FIFO ? SCHED_FIFO : SCHED_RR,
+            &param) == 0;
+    }
+
+    // pins the calling thread to the cpu.
+    // returns false if the cpu is not available (e.g. out of the cpuset of the process).
+    inline bool pin_to_cpu(int cpu) noexcept {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+
+    // locks (and pre-faults) the range. returns false if not permitted (e.g. RLIMIT_MEMLOCK).
+    inline bool lock_memory(const void* ptr, std::size_t bytes) noexcept {
+        return mlock(ptr, bytes) == 0;
+    }
+
+    inline void unlock_memory(const void* ptr, std::size_t bytes) noexcept {
+        munlock(ptr, bytes);
+    }
+
+    // the top range of the stack of the calling thread: [first, first + bytes)
+    // bytes is clamped to the half of the stack to stay away from the guard page.
+    // returns false if the stack cannot be queried.
+    inline bool current_stack_top(std::size_t bytes, void*& first, std::size_t& size) noexcept {
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) != 0) return false;
+        void* stack_addr{};
+        std::size_t stack_size{};
+        const bool ok = pthread_attr_getstack(&attr, &stack_addr, &stack_size) == 0;
+        pthread_attr_destroy(&attr);
+        if (!ok) return false;
+        size = bytes < stack_size / 2 ? bytes : stack_size / 2;
+        first = static_cast<unsigned char*>(stack_addr) + stack_size - size;
+        return true;
+    }
+} // namespace BA_Concurrency
+
+#endif // REALTIME_CONFIG_HPP
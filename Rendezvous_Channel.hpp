@@ -0,0 +1,515 @@
+// Rendezvous_Channel.hpp
+//
+// Description:
+//   The lock-free synchronous handoff channel (a zero-capacity queue)
+//   for the request/response between a dispatcher and the workers:
+//     A producer (offer) and a consumer (poll) meet at the channel
+//     and the data is handed off directly without buffering.
+//     The consumer wakes with the data already in hand.
+//
+//   The design follows the dual stack of Scherer, Lea and Scott (the unfair mode):
+//     The channel holds the waiting producers or the waiting consumers but never both.
+//     A thread finding a waiter of the complementary mode pops and fulfills the waiter.
+//     Otherwise, the thread pushes its own node and waits (spin-then-park).
+//
+// Requirements:
+// - T must be noexcept-movable.
+//
+// Design:
+//   The nodes live in a static pool of pow2_size<Waiter_Count_As_Pow2> nodes
+//   and are addressed by 32-bit indices (see Concurrent_Stack__LF_Static_Array_MPMC.hpp).
+//   Two versioned Treiber stacks share the pool:
+//     _waiters: the waiting nodes {index, mode, version}
+//               the mode bit of the head is the mode of all waiting nodes
+//     _free   : the free nodes {index, version}
+//   Node:
+//     _state    : the handoff state (see below)
+//     _semaphore: the parking semaphore of the waiter
+//     _source   : the data of the waiting producer (data nodes)
+//                 moved out by the fulfilling consumer after the claim.
+//                 Hence, the data of a timed-out producer is not moved from.
+//     _data     : the raw storage of the data handed to the waiting consumer (request nodes)
+//   Node states:
+//     WAITING  -> CLAIMED   : popped by a fulfiller
+//     CLAIMED  -> DONE      : the data is handed off (the waiter releases the node)
+//     WAITING  -> CANCELLED : the waiter has timed out
+//     CANCELLED-> POPPED or WAITER_DONE:
+//       the cancelled node is released by the last of the waiter and the popping thread
+//   The cancelled head nodes are popped (clean) by the timed-out waiters and by the arrivals.
+//   The threads finding the pool exhausted park on _pool_cv until a node is released.
+//
+// Semantics:
+//   offer(data, timeout) / poll(timeout):
+//     1. Load the _waiters head
+//     2. If the head is of the complementary mode:
+//          Pop the head node and claim it by CAS(WAITING, CLAIMED)
+//          (if the node is cancelled, release it and retry from Step 1)
+//          Hand off the data (move the data into or out of the node),
+//          mark the node as DONE and unpark the waiter
+//     3. Otherwise pop the cancelled head nodes, acquire a free node (park if the pool is exhausted),
+//        push the node of this mode (retry from Step 1 if the head has changed)
+//        and wait for the handoff:
+//          spin for a while and park on the semaphore until DONE or the timeout
+//     4. On timeout, cancel the node by CAS(WAITING, CANCELLED) and pop the cancelled head nodes
+//        (if the node is already claimed, wait for the handoff to be completed).
+//        The data of a timed-out offer is not moved from (see _source).
+//
+// Progress:
+//   Lock-free:
+//     The push and the pop are versioned CAS loops.
+//   Blocking:
+//     The waiters wait for a fulfiller (by definition of a synchronous channel).
+//     A claimed waiter waits for the fulfiller to complete the handoff
+//     (constant number of steps: a move and a store).
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release data before the visibility of the state transitions and
+//      to acquire data after observing the state transitions.
+//   2. The fulfiller releases the semaphore after publishing DONE.
+//      A late release may wake the next user of the recycled node spuriously
+//      which is tolerated as the waiters re-check the state.
+//   3. The unfair (LIFO) mode favors the most recently parked waiter
+//      which is the most likely to be still spinning (the hot cache and no wake up latency).
+//   4. release_node and the parking threads use the sequentially consistent order
+//      on _free and _pool_waiter_count (store-load ordering) to avoid a lost wake up.
+//      The mutex is taken by release_node only if a thread is parked.
+//
+// Cautions:
+//   1. The number of the concurrently waiting threads is bounded by the pool size.
+//      A thread finding no free node parks until a node is released or the deadline.
+//      A cancelled node below a live waiter is released when the waiter leaves the stack.
+//   2. The 31-bit version wraps around after 2^31 successful CAS operations on a stack.
+//      See Concurrent_Stack__LF_Static_Array_MPMC.hpp for the ABA discussion.
+//
+// TODOs:
+//   1. Consider the fair (FIFO) dual queue mode.
+
+#ifndef RENDEZVOUS_CHANNEL_HPP
+#define RENDEZVOUS_CHANNEL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <semaphore>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename T,
+        unsigned char Waiter_Count_As_Pow2 = 6>
+    requires (
+            Waiter_Count_As_Pow2 < 32 &&
+            std::is_nothrow_move_constructible_v<T>)
+    class Rendezvous_Channel {
+        static constexpr std::size_t _WAITER_COUNT = pow2_size<Waiter_Count_As_Pow2>;
+        static constexpr std::uint32_t _NULL_INDEX = UINT32_MAX;
+        static constexpr int _SPIN_COUNT = 1024;
+
+        // the node modes (the mode bit of the _waiters head)
+        static constexpr std::uint64_t _REQUEST = 0;
+        static constexpr std::uint64_t _DATA    = 1;
+
+        // the node states
+        static constexpr std::uint32_t _WAITING     = 0;
+        static constexpr std::uint32_t _CLAIMED     = 1;
+        static constexpr std::uint32_t _DONE        = 2;
+        static constexpr std::uint32_t _CANCELLED   = 3;
+        static constexpr std::uint32_t _POPPED      = 4;
+        static constexpr std::uint32_t _WAITER_DONE = 5;
+
+        struct Node {
+            std::atomic<std::uint32_t> _next{ _NULL_INDEX };
+            std::atomic<std::uint32_t> _state{ _WAITING };
+            std::counting_semaphore<INT_MAX> _semaphore{ 0 };
+            T* _source{};
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        // the head packs {index, mode, version} into a single word
+        //   bits  0-31: the index of the head node
+        //   bit     32: the mode of the waiting nodes (unused by the _free stack)
+        //   bits 33-63: the version incremented by each successful CAS
+        static constexpr std::uint32_t index(std::uint64_t head) noexcept {
+            return static_cast<std::uint32_t>(head);
+        }
+        static constexpr std::uint64_t mode(std::uint64_t head) noexcept {
+            return (head >> 32) & 1;
+        }
+        static constexpr std::uint64_t make_head(
+            std::uint32_t index,
+            std::uint64_t mode,
+            std::uint64_t old_head) noexcept
+        {
+            return ((old_head >> 33) + 1) << 33 | mode << 32 | index;
+        }
+
+        // the versioned Treiber pop of a free node (nullptr if the pool is exhausted)
+        // seq_cst: see Note 4 in the header documentation
+        Node* acquire_node() noexcept {
+            std::uint64_t old_head = _free.value.load(std::memory_order_seq_cst);
+            while (
+                index(old_head) != _NULL_INDEX &&
+                !_free.value.compare_exchange_weak(
+                    old_head,
+                    make_head(_nodes[index(old_head)]._next.load(std::memory_order_relaxed), 0, old_head),
+                    std::memory_order_seq_cst,
+                    std::memory_order_seq_cst));
+            if (index(old_head) == _NULL_INDEX) return nullptr;
+
+            // drain the late releases of the previous user (see Note 2 in the header documentation)
+            Node* node = &_nodes[index(old_head)];
+            while (node->_semaphore.try_acquire());
+            node->_state.store(_WAITING, std::memory_order_relaxed);
+            return node;
+        }
+
+        // the versioned Treiber push of a node to the _free stack
+        // and the wake up of a thread parked on the exhausted pool
+        void release_node(Node* node) noexcept {
+            const std::uint32_t node_index = static_cast<std::uint32_t>(node - _nodes);
+            std::uint64_t old_head = _free.value.load(std::memory_order_relaxed);
+            do {
+                node->_next.store(index(old_head), std::memory_order_relaxed);
+            } while (
+                !_free.value.compare_exchange_weak(
+                    old_head,
+                    make_head(node_index, 0, old_head),
+                    std::memory_order_seq_cst,
+                    std::memory_order_relaxed));
+
+            // seq_cst: see Note 4 in the header documentation
+            if (_pool_waiter_count.load(std::memory_order_seq_cst) == 0) return;
+            { std::scoped_lock lk(_pool_m); }
+            _pool_cv.notify_one();
+        }
+
+        // Step 3: acquire a free node parking while the pool is exhausted (see Cautions 1).
+        // returns nullptr if the deadline is reached.
+        template <typename Clock, typename Duration>
+        Node* acquire_node_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+            if (Node* node = acquire_node()) return node;
+
+            std::unique_lock lk(_pool_m);
+            _pool_waiter_count.fetch_add(1, std::memory_order_seq_cst);
+            Node* node;
+            while (!(node = acquire_node())) {
+                if (deadline == std::chrono::time_point<Clock, Duration>::max())
+                    _pool_cv.wait(lk);
+                else if (_pool_cv.wait_until(lk, deadline) == std::cv_status::timeout) {
+                    node = acquire_node();
+                    break;
+                }
+            }
+            _pool_waiter_count.fetch_sub(1, std::memory_order_relaxed);
+            return node;
+        }
+
+        // release a cancelled node by the last of the waiter and the popping thread
+        void release_cancelled(Node* node, std::uint32_t mark) noexcept {
+            const std::uint32_t other = mark == _POPPED ? _WAITER_DONE : _POPPED;
+            if (node->_state.exchange(mark, std::memory_order_acq_rel) == other)
+                release_node(node);
+        }
+
+        // Steps 3 and 4: pop the cancelled head nodes (the waiters have timed out).
+        // the popped state is stable: a cancelled node is released only after it is popped.
+        void clean() noexcept {
+            std::uint64_t old_head = _waiters.value.load(std::memory_order_acquire);
+            while (index(old_head) != _NULL_INDEX) {
+                Node* node = &_nodes[index(old_head)];
+                const std::uint32_t state = node->_state.load(std::memory_order_acquire);
+                if (state != _CANCELLED && state != _WAITER_DONE) return;
+                const std::uint32_t next = node->_next.load(std::memory_order_relaxed);
+                if (
+                    !_waiters.value.compare_exchange_weak(
+                        old_head,
+                        make_head(next, mode(old_head), old_head),
+                        std::memory_order_acq_rel,
+                        std::memory_order_acquire))
+                    continue;
+                release_cancelled(node, _POPPED);
+                old_head = _waiters.value.load(std::memory_order_acquire);
+            }
+        }
+
+        // Step 2: pop the head node of the complementary mode and claim it.
+        // returns nullptr if the head has changed to the same mode or to empty.
+        Node* pop_and_claim(std::uint64_t waiting_mode) noexcept {
+            std::uint64_t old_head = _waiters.value.load(std::memory_order_acquire);
+            while (index(old_head) != _NULL_INDEX && mode(old_head) == waiting_mode) {
+                Node* node = &_nodes[index(old_head)];
+                const std::uint32_t next = node->_next.load(std::memory_order_relaxed);
+                if (
+                    !_waiters.value.compare_exchange_weak(
+                        old_head,
+                        make_head(next, waiting_mode, old_head),
+                        std::memory_order_acq_rel,
+                        std::memory_order_acquire))
+                    continue;
+
+                // the node is owned by this thread now: claim it
+                std::uint32_t state = _WAITING;
+                if (
+                    node->_state.compare_exchange_strong(
+                        state,
+                        _CLAIMED,
+                        std::memory_order_acquire,
+                        std::memory_order_acquire))
+                    return node;
+
+                // cancelled by its waiter
+                release_cancelled(node, _POPPED);
+                old_head = _waiters.value.load(std::memory_order_acquire);
+            }
+            return nullptr;
+        }
+
+        // Step 2: complete the handoff and unpark the waiter
+        static void complete(Node* node) noexcept {
+            node->_state.store(_DONE, std::memory_order_release);
+            node->_semaphore.release();
+        }
+
+        // Step 3: push the node unless the head has changed to the complementary mode.
+        bool try_push(Node* node, std::uint64_t node_mode) noexcept {
+            const std::uint32_t node_index = static_cast<std::uint32_t>(node - _nodes);
+            std::uint64_t old_head = _waiters.value.load(std::memory_order_relaxed);
+            while (index(old_head) == _NULL_INDEX || mode(old_head) == node_mode) {
+                node->_next.store(index(old_head), std::memory_order_relaxed);
+                if (
+                    _waiters.value.compare_exchange_weak(
+                        old_head,
+                        make_head(node_index, node_mode, old_head),
+                        std::memory_order_release,
+                        std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+        // Steps 3 and 4: spin-then-park until DONE or the deadline.
+        // returns true if the handoff is completed, false if the node is cancelled.
+        template <typename Clock, typename Duration>
+        bool await_handoff(Node* node, const std::chrono::time_point<Clock, Duration>& deadline) {
+            // spin
+            for (int i = 0; i < _SPIN_COUNT; ++i) {
+                if (node->_state.load(std::memory_order_acquire) == _DONE) return true;
+                if ((i & 63) == 63) std::this_thread::yield();
+            }
+
+            // park
+            while (node->_state.load(std::memory_order_acquire) != _DONE) {
+                if (deadline == std::chrono::time_point<Clock, Duration>::max()) {
+                    node->_semaphore.acquire();
+                    continue;
+                }
+                if (node->_semaphore.try_acquire_until(deadline)) continue;
+
+                // Step 4: timed out
+                std::uint32_t state = _WAITING;
+                if (
+                    node->_state.compare_exchange_strong(
+                        state,
+                        _CANCELLED,
+                        std::memory_order_acq_rel,
+                        std::memory_order_acquire))
+                    return false;
+
+                // claimed: the fulfiller completes the handoff in a few steps
+                while (node->_state.load(std::memory_order_acquire) != _DONE)
+                    std::this_thread::yield();
+            }
+            return true;
+        }
+
+        // a deadline in the far future for the untimed operations
+        static auto no_deadline() noexcept {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+    public:
+
+        // link all nodes into the free stack
+        Rendezvous_Channel() noexcept {
+            for (std::size_t i = 0; i < _WAITER_COUNT; ++i)
+                _nodes[i]._next.store(
+                    i + 1 < _WAITER_COUNT ? static_cast<std::uint32_t>(i + 1) : _NULL_INDEX,
+                    std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected (no waiting threads).
+        ~Rendezvous_Channel() = default;
+
+        // Non-copyable/movable for simplicity
+        Rendezvous_Channel(const Rendezvous_Channel&) = delete;
+        Rendezvous_Channel& operator=(const Rendezvous_Channel&) = delete;
+        Rendezvous_Channel(Rendezvous_Channel&&) = delete;
+        Rendezvous_Channel& operator=(Rendezvous_Channel&&) = delete;
+
+        // hand off the data to a consumer waiting until the deadline.
+        // returns false if no consumer has taken the data until the deadline.
+        // a T rvalue is moved from only if the handoff succeeds
+        // (the other arguments are converted into a local T first).
+        //   1. Load the _waiters head
+        //   2. If consumers are waiting, fulfill the head consumer
+        //   3. Otherwise push a data node and wait for a consumer
+        //   4. On timeout, cancel the node (the data is not moved from)
+        template <typename U, typename Clock, typename Duration>
+        bool offer_until(U&& data_, const std::chrono::time_point<Clock, Duration>& deadline) {
+            if constexpr (std::is_same_v<U, T>)
+                return offer_from(data_, deadline);
+            else {
+                T data(std::forward<U>(data_));
+                return offer_from(data, deadline);
+            }
+        }
+
+        // offer_until on the data of the producer (moved from only by a successful handoff)
+        template <typename Clock, typename Duration>
+        bool offer_from(T& data, const std::chrono::time_point<Clock, Duration>& deadline) {
+            while (true) {
+                // Steps 1 and 2
+                if (Node* node = pop_and_claim(_REQUEST)) {
+                    ::new (node->to_ptr()) T(std::move(data));
+                    complete(node);
+                    return true;
+                }
+                if (Clock::now() >= deadline) return false;
+
+                // Step 3
+                clean();
+                Node* node = acquire_node_until(deadline);
+                if (!node) return false;
+                node->_source = &data;
+                if (!try_push(node, _DATA)) {
+                    release_node(node); // consumers arrived: retry
+                    continue;
+                }
+                if (await_handoff(node, deadline)) {
+                    release_node(node);
+                    return true;
+                }
+
+                // Step 4
+                release_cancelled(node, _WAITER_DONE);
+                clean();
+                return false;
+            }
+        }
+
+        // take the data from a producer waiting until the deadline.
+        // returns std::nullopt if no producer has handed off until the deadline.
+        //   1. Load the _waiters head
+        //   2. If producers are waiting, fulfill the head producer
+        //   3. Otherwise push a request node and wait for a producer
+        //   4. On timeout, cancel the node
+        template <typename Clock, typename Duration>
+        std::optional<T> poll_until(const std::chrono::time_point<Clock, Duration>& deadline) {
+            while (true) {
+                // Steps 1 and 2
+                if (Node* node = pop_and_claim(_DATA)) {
+                    std::optional<T> data{ std::move(*node->_source) };
+                    complete(node);
+                    return data;
+                }
+                if (Clock::now() >= deadline) return std::nullopt;
+
+                // Step 3
+                clean();
+                Node* node = acquire_node_until(deadline);
+                if (!node) return std::nullopt;
+                if (!try_push(node, _REQUEST)) {
+                    release_node(node); // producers arrived: retry
+                    continue;
+                }
+                if (await_handoff(node, deadline)) {
+                    T* ptr = node->to_ptr();
+                    std::optional<T> data{ std::move(*ptr) };
+                    if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+                    release_node(node);
+                    return data;
+                }
+
+                // Step 4
+                release_cancelled(node, _WAITER_DONE);
+                clean();
+                return std::nullopt;
+            }
+        }
+
+        // timed offer
+        template <typename U, typename Rep, typename Period>
+        bool offer(U&& data, const std::chrono::duration<Rep, Period>& timeout) {
+            return offer_until(std::forward<U>(data), std::chrono::steady_clock::now() + timeout);
+        }
+
+        // timed poll
+        template <typename Rep, typename Period>
+        std::optional<T> poll(const std::chrono::duration<Rep, Period>& timeout) {
+            return poll_until(std::chrono::steady_clock::now() + timeout);
+        }
+
+        // non-blocking offer: succeeds only if a consumer is waiting
+        template <typename U>
+        bool try_offer(U&& data) {
+            return offer_until(std::forward<U>(data), std::chrono::steady_clock::time_point::min());
+        }
+
+        // non-blocking poll: succeeds only if a producer is waiting
+        std::optional<T> try_poll() {
+            return poll_until(std::chrono::steady_clock::time_point::min());
+        }
+
+        // blocking offer: waits for a consumer
+        template <typename U>
+        void put(U&& data) {
+            offer_until(std::forward<U>(data), no_deadline());
+        }
+
+        // blocking poll: waits for a producer
+        T take() {
+            return *poll_until(no_deadline());
+        }
+
+        // the number of the waiting producers (positive) or consumers (negative) is not tracked.
+        // returns true if producers are waiting.
+        bool has_waiting_producers() const noexcept {
+            const std::uint64_t head = _waiters.value.load(std::memory_order_acquire);
+            return index(head) != _NULL_INDEX && mode(head) == _DATA;
+        }
+
+        // returns true if consumers are waiting.
+        bool has_waiting_consumers() const noexcept {
+            const std::uint64_t head = _waiters.value.load(std::memory_order_acquire);
+            return index(head) != _NULL_INDEX && mode(head) == _REQUEST;
+        }
+
+    private:
+
+        // MEMBERS:
+        // The heads of the two Treiber stacks sharing the node pool.
+        // Initially, all nodes are in the free stack.
+        cache_line_wrapper<std::atomic<std::uint64_t>> _waiters{ _NULL_INDEX };
+        cache_line_wrapper<std::atomic<std::uint64_t>> _free{ 0 };
+        Node _nodes[_WAITER_COUNT];
+
+        // The threads parked on the exhausted pool (see Cautions 1).
+        std::atomic<std::size_t> _pool_waiter_count{ 0 };
+        std::mutex _pool_m;
+        std::condition_variable _pool_cv;
+    };
+} // namespace BA_Concurrency
+
+#endif // RENDEZVOUS_CHANNEL_HPP
@@ -0,0 +1,201 @@
+// Reorder_Buffer.hpp
+//
+// Description:
+//   A lock-free reorder buffer for the order-preserving parallel stages:
+//     The workers complete the items out of order and deposit the result of item i.
+//     A single emitter drains the results in the input order (the contiguous prefix)
+//     as soon as the prefix is completed.
+//   The buffer is a sequence-indexed ring of pow2_size<Capacity_As_Pow2> slots.
+//   The capacity bounds the window of the in-flight results:
+//     a worker depositing a result beyond the window waits for the emitter (the backpressure).
+//
+// Requirements:
+// - T must be noexcept-movable.
+// - Each sequence number is deposited exactly once starting from 0 without gaps
+//   (e.g. the sequence numbers assigned by the source of the stage).
+//
+// Design:
+//   Slot:
+//     _state: 2 * i     : the slot is free for the result of sequence i
+//             2 * i + 1 : the slot holds the result of sequence i
+//     _data : the raw storage of the result
+//   Slot k is initialized as free for sequence k.
+//   _next: the next sequence to be emitted (modified by the emitter only)
+//
+// Semantics:
+//   deposit(i, result):
+//     1. Wait until the slot of i is free for i (spin-then-wait)
+//        (i.e. the result of i - capacity is emitted)
+//     2. Construct the result in the slot
+//     3. Store 2 * i + 1 and notify the emitter
+//   try_pop (the emitter):
+//     1. If the slot of _next does not hold the result of _next, return std::nullopt
+//     2. Move the result out of the slot
+//     3. Store 2 * (_next + capacity) (free for the next lap) and notify the depositor
+//     4. Increment _next
+//   pop (the emitter): waits for the result of _next (spin-then-wait)
+//   drain(f) (the emitter): applies f on the completed prefix and returns the number of the results
+//
+// Progress:
+//   try_deposit and try_pop are wait-free.
+//   deposit and pop are blocking by definition.
+//
+// Notes:
+//   1. Memory orders are chosen to
+//      release the result before the visibility of the state and
+//      to acquire the result after observing the state.
+//   2. The waits use std::atomic::wait on the slot state (futex-based on linux).
+//
+// Cautions:
+//   1. A sequence number deposited twice or never deposited breaks the order (UB).
+//   2. The capacity must exceed the number of the in-flight items
+//      whose results are required to emit the prefix.
+//      Otherwise, the workers may wait for each other.
+//
+// TODOs:
+//   1. Consider the worker-side emission (the worker completing the prefix runs the emitter).
+
+#ifndef REORDER_BUFFER_HPP
+#define REORDER_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "aux_type_traits.hpp"
+#include "cache_line_wrapper.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename T,
+        unsigned char Capacity_As_Pow2 = 10>
+    requires (std::is_nothrow_move_constructible_v<T>)
+    class Reorder_Buffer {
+        static constexpr std::size_t _CAPACITY = pow2_size<Capacity_As_Pow2>;
+        static constexpr std::size_t _MASK = _CAPACITY - 1;
+        static constexpr int _SPIN_COUNT = 256;
+
+        struct Slot {
+            std::atomic<std::uint64_t> _state{ 0 };
+            alignas(T) unsigned char _data[sizeof(T)];
+            T* to_ptr() noexcept { return std::launder(reinterpret_cast<T*>(_data)); }
+        };
+
+        // spin-then-wait until the state equals the expected
+        static void await_state(const Slot& slot, std::uint64_t expected) noexcept {
+            for (int i = 0; i < _SPIN_COUNT; ++i)
+                if (slot._state.load(std::memory_order_acquire) == expected) return;
+            std::uint64_t state;
+            while ((state = slot._state.load(std::memory_order_acquire)) != expected)
+                slot._state.wait(state, std::memory_order_acquire);
+        }
+
+        // Steps 2 and 3 of deposit
+        template <typename U>
+        static void fill(Slot& slot, std::uint64_t sequence, U&& result) {
+            ::new (slot.to_ptr()) T(std::forward<U>(result));
+            slot._state.store(2 * sequence + 1, std::memory_order_release);
+            slot._state.notify_all();
+        }
+
+        // Steps 2 to 4 of try_pop (the slot holds the result of _next)
+        T take(Slot& slot) noexcept {
+            T* ptr = slot.to_ptr();
+            T result{ std::move(*ptr) };
+            if constexpr (!std::is_trivially_destructible_v<T>) ptr->~T();
+            const std::uint64_t next = _next.value.load(std::memory_order_relaxed);
+            slot._state.store(2 * (next + _CAPACITY), std::memory_order_release);
+            slot._state.notify_all();
+            _next.value.store(next + 1, std::memory_order_release);
+            return result;
+        }
+
+    public:
+
+        Reorder_Buffer() noexcept {
+            for (std::size_t i = 0; i < _CAPACITY; ++i)
+                _slots[i]._state.store(2 * i, std::memory_order_relaxed);
+        }
+
+        // Single-threaded context expected.
+        ~Reorder_Buffer() {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+                for (auto& slot : _slots)
+                    if (slot._state.load(std::memory_order_relaxed) & 1) slot.to_ptr()->~T();
+        }
+
+        // Non-copyable/movable for simplicity
+        Reorder_Buffer(const Reorder_Buffer&) = delete;
+        Reorder_Buffer& operator=(const Reorder_Buffer&) = delete;
+        Reorder_Buffer(Reorder_Buffer&&) = delete;
+        Reorder_Buffer& operator=(Reorder_Buffer&&) = delete;
+
+        // deposit the result of the sequence (waits if the sequence is beyond the window):
+        //   1. Wait until the slot is free for the sequence
+        //   2. Construct the result in the slot
+        //   3. Publish the result and notify the emitter
+        template <typename U>
+        void deposit(std::uint64_t sequence, U&& result) {
+            Slot& slot = _slots[sequence & _MASK];
+            await_state(slot, 2 * sequence);
+            fill(slot, sequence, std::forward<U>(result));
+        }
+
+        // returns false if the sequence is beyond the window
+        template <typename U>
+        bool try_deposit(std::uint64_t sequence, U&& result) {
+            Slot& slot = _slots[sequence & _MASK];
+            if (slot._state.load(std::memory_order_acquire) != 2 * sequence) return false;
+            fill(slot, sequence, std::forward<U>(result));
+            return true;
+        }
+
+        // the emitter: returns the next result in order if completed
+        std::optional<T> try_pop() noexcept {
+            const std::uint64_t next = _next.value.load(std::memory_order_relaxed);
+            Slot& slot = _slots[next & _MASK];
+            if (slot._state.load(std::memory_order_acquire) != 2 * next + 1) return std::nullopt;
+            return std::optional<T>{ take(slot) };
+        }
+
+        // the emitter: waits for the next result in order
+        T pop() noexcept {
+            const std::uint64_t next = _next.value.load(std::memory_order_relaxed);
+            Slot& slot = _slots[next & _MASK];
+            await_state(slot, 2 * next + 1);
+            return take(slot);
+        }
+
+        // the emitter: applies f on the completed prefix.
+        // returns the number of the emitted results.
+        template <typename F>
+        std::size_t drain(F&& f) {
+            std::size_t count{};
+            while (auto result = try_pop()) {
+                f(std::move(*result));
+                ++count;
+            }
+            return count;
+        }
+
+        // the next sequence to be emitted
+        std::uint64_t next_sequence() const noexcept {
+            return _next.value.load(std::memory_order_acquire);
+        }
+
+        static constexpr std::size_t capacity() noexcept {
+            return _CAPACITY;
+        }
+
+    private:
+
+        // MEMBERS:
+        cache_line_wrapper<std::atomic<std::uint64_t>> _next{ 0 };
+        Slot _slots[_CAPACITY];
+    };
+} // namespace BA_Concurrency
+
+#endif // REORDER_BUFFER_HPP
@@ -0,0 +1,146 @@
+// Strand.hpp
+//
+// Description:
+//   A serial executor (a strand) running its jobs in the submission order
+//   on the workers of an executor (e.g. a thread pool), one job at a time:
+//     1. The jobs are pushed into a lock-free MPSC stack (stack_LF_linked_MPSC).
+//     2. An atomic flag (_scheduled) guarantees that at most one activation
+//        of the strand is scheduled on the executor at a time.
+//     3. An activation runs a batch of jobs (up to Batch_Size)
+//        and then reschedules itself if more jobs are pending.
+//        Hence, a busy strand does not monopolize a worker.
+//   The jobs of a strand never run concurrently
+//   and no worker blocks on a lock protecting the state of the strand.
+//   Different strands run in parallel.
+//
+// Requirements:
+// - Executor must provide submit(std::function<void()>).
+// - The jobs must not throw.
+//
+// Design:
+//   _jobs     : the MPSC stack of the posted jobs
+//   _batch    : the jobs detached from the stack by pop_all (in the FIFO order after the reversal)
+//   _scheduled: true while an activation is scheduled or running
+//   The single consumer of _jobs is the running activation.
+//
+// Semantics:
+//   post(job):
+//     1. Push the job into _jobs
+//     2. Schedule an activation if not scheduled yet (exchange(_scheduled, true))
+//   activation:
+//     1. If the batch is consumed, detach all jobs from _jobs and reverse them (FIFO)
+//     2. Run the batch up to Batch_Size jobs
+//     3. If jobs are pending, resubmit the activation
+//        Otherwise, clear _scheduled and re-check _jobs:
+//          a job posted after the check of Step 3 and before the clearing of _scheduled
+//          did not schedule an activation (see Notes)
+//
+// Progress:
+//   post is lock-free.
+//
+// Notes:
+//   1. The clearing of _scheduled and the re-check of _jobs in Step 3 are separated
+//      by a sequentially consistent fence (store-load ordering)
+//      against the push and the exchange of post.
+//   2. The activation runs on the executor as a regular job.
+//
+// Cautions:
+//   1. A strand must outlive its scheduled activations.
+//      Destroy a strand in a single-threaded context (no pending jobs).
+//
+// TODOs:
+//   1. Consider the inline execution of post when called from the running strand (dispatch).
+
+#ifndef STRAND_HPP
+#define STRAND_HPP
+
+#include <cstddef>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include "Concurrent_Stack__LF_Linked_MPSC.hpp"
+
+namespace BA_Concurrency {
+    template <
+        typename Executor,
+        std::size_t Batch_Size = 64>
+    requires (Batch_Size > 0)
+    class Strand {
+        using job_t = std::function<void()>;
+
+        // Step 2 of post: schedule an activation if not scheduled yet
+        void schedule() {
+            if (!_scheduled.exchange(true, std::memory_order_seq_cst))
+                _executor->submit([this] { activate(); });
+        }
+
+        void activate() {
+            // Step 1
+            if (_batch_index == _batch.size()) {
+                _batch = _jobs.pop_all();
+                std::reverse(_batch.begin(), _batch.end());
+                _batch_index = 0;
+            }
+
+            // Step 2
+            const Strand* outer = _current;
+            _current = this;
+            for (std::size_t n = 0; n < Batch_Size && _batch_index < _batch.size(); ++n) {
+                job_t job{ std::move(_batch[_batch_index++]) };
+                job();
+            }
+            _current = outer;
+
+            // Step 3
+            if (_batch_index < _batch.size() || !_jobs.empty()) {
+                _executor->submit([this] { activate(); });
+                return;
+            }
+            _batch.clear();
+            _batch_index = 0;
+            _scheduled.store(false, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!_jobs.empty()) schedule();
+        }
+
+    public:
+
+        explicit Strand(Executor& executor) noexcept : _executor(&executor) {}
+
+        // Single-threaded context expected (no scheduled activation).
+        ~Strand() = default;
+
+        // Non-copyable/movable for simplicity
+        Strand(const Strand&) = delete;
+        Strand& operator=(const Strand&) = delete;
+        Strand(Strand&&) = delete;
+        Strand& operator=(Strand&&) = delete;
+
+        // 1. Push the job into _jobs
+        // 2. Schedule an activation if not scheduled yet
+        void post(job_t job) {
+            _jobs.push(std::move(job));
+            schedule();
+        }
+
+        // returns true if called from a job of this strand
+        bool running_in_this_thread() const noexcept {
+            return _current == this;
+        }
+
+    private:
+
+        // MEMBERS:
+        // _batch and _batch_index are accessed by the running activation only.
+        Executor* const _executor;
+        stack_LF_linked_MPSC<job_t> _jobs;
+        std::vector<job_t> _batch;
+        std::size_t _batch_index{};
+        std::atomic<bool> _scheduled{ false };
+        static inline thread_local const Strand* _current{};
+    };
+} // namespace BA_Concurrency
+
+#endif // STRAND_HPP
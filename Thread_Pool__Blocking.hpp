@@ -4,7 +4,8 @@
 #define THREAD_POOL__BLOCKING_HPP
 
 #include "IThread_Pool.hpp"
-#include "Concurrent_Queue__Blocking.hpp"
+#include "Pool_Scheduler.hpp"
+#include "Concurrent_Queue__Blocking_CoDel.hpp"
 #include <vector>
 #include <thread>
 #include <memory>
@@ -17,7 +18,19 @@ namespace BA_Concurrency {
     public:
         explicit Thread_Pool__Blocking(
             size_t thread_count = std::thread::hardware_concurrency())
-                : _thread_count(thread_count == 0 ? 1 : thread_count)
+                : Thread_Pool__Blocking(thread_count, CoDel_Config{}) {}
+
+        // the pool with the active queue management (see Concurrent_Queue__Blocking_CoDel.hpp):
+        // the jobs dropped under overload are passed to on_reject instead of running.
+        Thread_Pool__Blocking(
+            size_t thread_count,
+            CoDel_Config config,
+            std::function<void(job_t)> on_reject = {})
+                : _jobs(config, [this, on_reject = std::move(on_reject)](job_t job) {
+                      if (on_reject) on_reject(std::move(job));
+                      complete_job();
+                  }),
+                  _thread_count(thread_count == 0 ? 1 : thread_count)
         {
             for (size_t i = 0; i < _thread_count; ++i)
                 _threads.emplace_back([this] { worker_loop(); });
@@ -28,8 +41,8 @@ namespace BA_Concurrency {
         }
 
         void submit(std::function<void()> job) override {
-            _jobs.push(std::move(job));
             ++_jobs_in_progress;
+            _jobs.push(std::move(job));
         }
 
         // utility function
@@ -40,15 +53,15 @@ namespace BA_Concurrency {
             auto task = std::make_shared<std::packaged_task<R()>>(
                 std::bind(std::forward<F>(f), std::forward<Args>(args)...));
             auto fut = task->get_future();
-            _jobs.push([task]() { (*task)(); });
-
             ++_jobs_in_progress;
+            _jobs.push([task]() { (*task)(); });
             return fut;
         }
 
         inline void shutdown() override {
             if (bool expected{true}; !_running.compare_exchange_strong(expected, false))
                 return;
+            _jobs.close(); // the workers drain the queue and exit
             for (auto& t : _threads) t.join();
         }
 
@@ -56,11 +69,21 @@ namespace BA_Concurrency {
             return _thread_count;
         }
 
+        // the sender/receiver scheduler of the pool (see Pool_Scheduler.hpp)
+        inline Pool_Scheduler<Thread_Pool__Blocking> get_scheduler() noexcept {
+            return Pool_Scheduler<Thread_Pool__Blocking>(*this);
+        }
+
         inline void wait_all_jobs() override {
             std::unique_lock lk(_m);
             _cv.wait(lk, [&]{ return _jobs_in_progress == 0 && _jobs.empty(); });
         }
 
+        // the number of the jobs dropped by the active queue management
+        inline size_t get_rejected_job_count() const noexcept {
+            return _jobs.dropped_count();
+        }
+
     private:
 
         inline void worker_loop() {
@@ -71,13 +94,18 @@ namespace BA_Concurrency {
                     else continue;
                 }
                 job.value()();
-                --_jobs_in_progress;
-                if (_jobs_in_progress == 0)
-                    _cv.notify_all();
+                complete_job();
+            }
+        }
+
+        inline void complete_job() {
+            if (--_jobs_in_progress == 0) {
+                std::scoped_lock lk(_m);
+                _cv.notify_all();
             }
         }
 
-        Concurrent_Queue__Blocking<job_t> _jobs;
+        Concurrent_Queue__Blocking_CoDel<job_t> _jobs;
         std::vector<std::thread> _threads;
         size_t _thread_count{};
         std::atomic<size_t> _jobs_in_progress{0};
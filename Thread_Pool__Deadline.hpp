@@ -4,6 +4,7 @@
 #define THREAD_POOL__DEADLINE_HPP
 
 #include "IThread_Pool.hpp"
+#include "Pool_Scheduler.hpp"
 #include <queue>
 #include <mutex>
 #include <condition_variable>
@@ -58,6 +59,11 @@ namespace BA_Concurrency {
             return _thread_count;
         }
 
+        // the sender/receiver scheduler of the pool (see Pool_Scheduler.hpp)
+        inline Pool_Scheduler<Thread_Pool__Deadline> get_scheduler() noexcept {
+            return Pool_Scheduler<Thread_Pool__Deadline>(*this);
+        }
+
         inline void wait_all_jobs() override {
             /*
             TODO: wait_all_jobs
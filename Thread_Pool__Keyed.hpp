@@ -0,0 +1,66 @@
+// Thread_Pool__Keyed.hpp
+//
+// Description:
+//   Extends a thread pool by submit_keyed(key, job) which runs the jobs of a key
+//   in the submission order and the jobs of different keys in parallel:
+//     The keys are mapped to a fixed number of strands (see Strand.hpp) by hash.
+//     The jobs of the keys sharing a strand are serialized as well.
+//   The ordering is achieved without the mutexes inside the jobs
+//   and hence without the blocked workers and the lock convoys.
+//
+// Requirements:
+// - Pool must provide submit(std::function<void()>).
+// - Pool must join its workers in its destructor.
+// - The jobs must not throw.
+//
+// Cautions:
+//   1. A key with a heavy load delays the other keys of its strand.
+//      Increase Strand_Count_As_Pow2 to reduce the sharing.
+
+#ifndef THREAD_POOL__KEYED_HPP
+#define THREAD_POOL__KEYED_HPP
+
+#include "Strand.hpp"
+#include "aux_type_traits.hpp"
+#include <cstddef>
+#include <memory>
+#include <functional>
+#include <utility>
+
+namespace BA_Concurrency {
+    template <typename Pool, unsigned char Strand_Count_As_Pow2, std::size_t Batch_Size>
+    struct Keyed_Strands {
+        std::unique_ptr<Strand<Pool, Batch_Size>> _strands[pow2_size<Strand_Count_As_Pow2>];
+    };
+
+    // Keyed_Strands is the first base:
+    // the strands outlive the workers joined by the destructor of Pool.
+    template <
+        typename Pool,
+        typename Key = std::size_t,
+        typename Hash = std::hash<Key>,
+        unsigned char Strand_Count_As_Pow2 = 6,
+        std::size_t Batch_Size = 64>
+    class Thread_Pool__Keyed
+        : private Keyed_Strands<Pool, Strand_Count_As_Pow2, Batch_Size>, public Pool
+    {
+        static constexpr std::size_t _STRAND_MASK = pow2_size<Strand_Count_As_Pow2> - 1;
+
+        using Keyed_Strands<Pool, Strand_Count_As_Pow2, Batch_Size>::_strands;
+
+    public:
+
+        template <typename... Args>
+        explicit Thread_Pool__Keyed(Args&&... args) : Pool(std::forward<Args>(args)...) {
+            for (auto& strand : _strands)
+                strand = std::make_unique<Strand<Pool, Batch_Size>>(static_cast<Pool&>(*this));
+        }
+
+        // runs the job after the previously submitted jobs of the key
+        void submit_keyed(const Key& key, std::function<void()> job) {
+            _strands[Hash{}(key) & _STRAND_MASK]->post(std::move(job));
+        }
+    };
+} // namespace BA_Concurrency
+
+#endif // THREAD_POOL__KEYED_HPP
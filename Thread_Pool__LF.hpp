@@ -4,11 +4,14 @@
 #define THREAD_POOL__LF_HPP
 
 #include "IThread_Pool.hpp"
+#include "Pool_Scheduler.hpp"
 #include "Concurrent_Queue__LF_Ring_MPMC.hpp"
+#include "Realtime_Config.hpp"
 #include "tp_util.hpp"
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <utility>
 
 namespace BA_Concurrency {
     class Thread_Pool__LF : public IThread_Pool {
@@ -17,24 +20,30 @@ namespace BA_Concurrency {
     public:
         explicit Thread_Pool__LF(
             size_t thread_count = std::thread::hardware_concurrency())
-                : _thread_count(thread_count == 0 ? 1 : thread_count)
+                : Thread_Pool__LF(Realtime_Config{}, thread_count == 0 ? 1 : thread_count) {}
+
+        // the real-time pool (see Realtime_Config.hpp).
+        // thread_count = 0: a worker per listed cpu (or per hardware thread if no cpu is listed).
+        // The settings failing for the lack of the privileges are skipped (see get_realtime_status).
+        explicit Thread_Pool__LF(Realtime_Config config, size_t thread_count = 0)
+            : _config(std::move(config))
         {
-            for (size_t i = 0; i < thread_count; ++i) {
-                _threads.emplace_back([this] {
-                    while (_running.load(std::memory_order_relaxed)) {
-                        auto job = _jobs.try_pop();
-                        if (job.has_value()) {
-                            job.value()();
-                        } else {
-                            std::this_thread::yield();
-                        }
-                    }
-                });
-            }
+            _thread_count = thread_count != 0
+                ? thread_count
+                : !_config._cpus.empty() ? _config._cpus.size() : std::thread::hardware_concurrency();
+            if (_thread_count == 0) _thread_count = 1;
+
+            if (_config._lock_memory && lock_memory(&_jobs, sizeof(_jobs)))
+                _status._queue_locked.store(true, std::memory_order_relaxed);
+
+            for (size_t i = 0; i < _thread_count; ++i)
+                _threads.emplace_back([this, i] { worker_loop(i); });
         }
 
         ~Thread_Pool__LF() {
             if (_running) shutdown();
+            if (_status._queue_locked.load(std::memory_order_relaxed))
+                unlock_memory(&_jobs, sizeof(_jobs));
         }
 
         inline void submit(job_t job) override {
@@ -51,6 +60,11 @@ namespace BA_Concurrency {
             return _thread_count;
         }
 
+        // the sender/receiver scheduler of the pool (see Pool_Scheduler.hpp)
+        inline Pool_Scheduler<Thread_Pool__LF> get_scheduler() noexcept {
+            return Pool_Scheduler<Thread_Pool__LF>(*this);
+        }
+
         inline void wait_all_jobs() override {
             /*
             TODO: wait_all_jobs
@@ -58,7 +72,49 @@ namespace BA_Concurrency {
             ;
         }
 
+        // the real-time settings achieved by the workers
+        inline const Realtime_Status& get_realtime_status() const noexcept {
+            return _status;
+        }
+
     private:
+
+        // 1. Apply the real-time settings of the worker (skipping the failing ones)
+        // 2. Poll the jobs (pause-spin if busy polling, yield otherwise)
+        // 3. Unlock the stack of the worker
+        inline void worker_loop(size_t index) {
+            // Step 1
+            if (!_config._cpus.empty() && pin_to_cpu(_config._cpus[index % _config._cpus.size()]))
+                _status._pinned_workers.fetch_add(1, std::memory_order_relaxed);
+            if (apply_realtime_policy(_config._policy, _config._priority))
+                _status._scheduled_workers.fetch_add(1, std::memory_order_relaxed);
+            void* stack{};
+            size_t stack_size{};
+            const bool stack_locked =
+                _config._lock_memory &&
+                current_stack_top(_config._stack_lock_bytes, stack, stack_size) &&
+                lock_memory(stack, stack_size);
+            if (stack_locked)
+                _status._locked_worker_stacks.fetch_add(1, std::memory_order_relaxed);
+
+            // Step 2
+            while (_running.load(std::memory_order_relaxed)) {
+                auto job = _jobs.try_pop();
+                if (job.has_value()) {
+                    job.value()();
+                } else if (_config._busy_poll) {
+                    cpu_relax();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+
+            // Step 3: the thread stacks are cached by the runtime
+            if (stack_locked) unlock_memory(stack, stack_size);
+        }
+
+        const Realtime_Config _config;
+        Realtime_Status _status;
         jobs_t _jobs;
         std::vector<std::thread> _threads;
         size_t _thread_count{};
@@ -0,0 +1,68 @@
+// Thread_Pool__Unique.hpp
+//
+// Description:
+//   Extends a thread pool by submit_unique(key, job) which allows at most one queued job per key:
+//     A duplicate submission is coalesced (dropped) while the job of the key is still queued.
+//     The key is erased just before the job starts running.
+//     Hence, a submission during the run of the job queues a new job
+//     (the new job observes the effects of the running job or runs after it).
+//   The queued keys are kept in a Concurrent_Hash_Set (lock-free insert_if_absent and erase).
+//
+// Requirements:
+// - Pool must provide submit(std::function<void()>).
+// - Pool must join its workers in its destructor.
+//
+// Cautions:
+//   1. The key of a job which never runs (e.g. submitted after shutdown) is never erased.
+
+#ifndef THREAD_POOL__UNIQUE_HPP
+#define THREAD_POOL__UNIQUE_HPP
+
+#include "Concurrent_Hash_Set.hpp"
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace BA_Concurrency {
+    template <typename Key, typename Hash>
+    struct Queued_Keys {
+        Concurrent_Hash_Set<Key, Hash> _queued_keys;
+    };
+
+    // Queued_Keys is the first base:
+    // the set outlives the workers joined by the destructor of Pool.
+    template <
+        typename Pool,
+        typename Key = std::uint64_t,
+        typename Hash = std::hash<Key>>
+    class Thread_Pool__Unique : private Queued_Keys<Key, Hash>, public Pool {
+        using Queued_Keys<Key, Hash>::_queued_keys;
+
+    public:
+
+        using Pool::Pool;
+
+        // returns false if a job with the same key is still queued (the job is coalesced)
+        bool submit_unique(Key key, std::function<void()> job) {
+            if (!_queued_keys.insert_if_absent(key)) return false;
+            try {
+                Pool::submit([this, key, job = std::move(job)] {
+                    _queued_keys.erase(key);
+                    job();
+                });
+            }
+            catch (...) {
+                _queued_keys.erase(key);
+                throw;
+            }
+            return true;
+        }
+
+        // returns true if a job with the key is queued
+        bool is_queued(Key key) const {
+            return _queued_keys.contains(key);
+        }
+    };
+} // namespace BA_Concurrency
+
+#endif // THREAD_POOL__UNIQUE_HPP
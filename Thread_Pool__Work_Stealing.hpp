@@ -4,6 +4,7 @@
 #define THREAD_POOL__WORK_STEALING_HPP
 
 #include "IThread_Pool.hpp"
+#include "Pool_Scheduler.hpp"
 #include <deque>
 #include <mutex>
 #include <thread>
@@ -36,12 +37,11 @@ namespace BA_Concurrency {
         }
 
         void submit(std::function<void()> job) override {
-            auto task = std::make_shared<std::packaged_task<void()>>();
             size_t id = _next.fetch_add(1, std::memory_order_relaxed) % _jds.size();
             auto& jd = _jds[id];
             {
                 std::scoped_lock lk(jd._m);
-                jd._jd.push_back(std::move([task]() { (*task)(); }));
+                jd._jd.push_back(std::move(job));
             }
         }
 
@@ -75,6 +75,11 @@ namespace BA_Concurrency {
             return _thread_count;
         }
 
+        // the sender/receiver scheduler of the pool (see Pool_Scheduler.hpp)
+        inline Pool_Scheduler<Thread_Pool__Work_Stealing> get_scheduler() noexcept {
+            return Pool_Scheduler<Thread_Pool__Work_Stealing>(*this);
+        }
+
         inline void wait_all_jobs() override {
             /*
             TODO: wait_all_jobs
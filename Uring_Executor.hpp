@@ -0,0 +1,421 @@
+// Uring_Executor.hpp
+//
+// Description:
+//   An asynchronous file I/O executor on io_uring (raw syscalls, no liburing)
+//   delivering the completions as the continuations onto a thread pool:
+//     1. The submitters (e.g. the pool workers) write the submission queue entries (SQEs)
+//        into the shared submission ring and return immediately.
+//     2. The SQEs are submitted to the kernel in batches (io_uring_enter):
+//        when Batch_Size SQEs are pending or on flush().
+//     3. A reaper thread waits for the completion queue entries (CQEs)
+//        and submits the continuations onto the pool: continuation(result).
+//        result: the number of the bytes transferred or -errno.
+//   Hence, the pool workers never block on the disk I/O.
+//   The executor owns a set of the registered (fixed) buffers carved out of a page-aligned static arena
+//   (see Simple_Static_Arena.hpp) and tracked by a Bitmap_Allocator:
+//     the kernel maps the registered buffers once instead of per operation (READ_FIXED and WRITE_FIXED).
+//
+// Requirements:
+// - Linux 5.6+ (IORING_OP_READ and IORING_OP_WRITE).
+// - The pool must outlive the executor.
+// - The memory of an operation (the buffer) must stay valid until its continuation runs.
+// - The continuations must not throw.
+//
+// Design:
+//   The submission ring is written under _sq_m (a single producer for the kernel).
+//   The completion ring is consumed by the reaper thread only.
+//   The ring indices shared with the kernel are accessed by std::atomic_ref:
+//     acquire the tail of the kernel and release the own tail (or head).
+//   The SQ array maps the slot i to the SQE i once (identity mapping).
+//   user_data: the pointer of the operation holding the continuation (0: the wake-up NOP).
+//
+// Semantics:
+//   read/write (and the fixed versions):
+//     1. Allocate the operation (the continuation)
+//     2. Wait for a free SQE (flush if the ring is full)
+//     3. Fill the SQE and publish the SQ tail
+//     4. Flush if Batch_Size SQEs are pending
+//   reaper:
+//     1. Wait for at least one CQE (io_uring_enter with IORING_ENTER_GETEVENTS)
+//     2. Retry the pending submissions (e.g. a flush failed with EBUSY) under _sq_m
+//        (the lock orders the allocation of the operations before their dispatch)
+//     3. Submit the continuations of the CQEs onto the pool and publish the CQ head
+//     4. Exit if stopping and no operation is in flight
+//
+// Progress:
+//   The submitters block on _sq_m and on io_uring_enter only (never on the I/O).
+//
+// Notes:
+//   1. If the registration of the buffers fails (e.g. RLIMIT_MEMLOCK),
+//      the fixed operations fall back to the plain READ and WRITE on the same buffers.
+//   2. The executor relies on IORING_FEAT_NODROP (Linux 5.5+) for the CQ overflow.
+//
+// Cautions:
+//   1. With Batch_Size > 1, call flush() after a burst of the submissions.
+//      Otherwise, the last SQEs wait for the next submission.
+//   2. The buffer pool is large (pow2_size<Buffer_Count_As_Pow2> * Buffer_Size bytes): allocate the executor on the heap.
+//   3. A continuation waiting for a buffer released by another continuation may exhaust the workers of the pool.
+//
+// TODOs:
+//   1. Consider IORING_SETUP_SQPOLL for the privileged deployments (no submission syscalls).
+
+#ifndef URING_EXECUTOR_HPP
+#define URING_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "IThread_Pool.hpp"
+#include "Bitmap_Allocator.hpp"
+#include "Simple_Static_Arena.hpp"
+#include "aux_type_traits.hpp"
+
+namespace BA_Concurrency {
+    // a registered buffer of Uring_Executor
+    struct Uring_Buffer {
+        std::byte* _data{};
+        std::size_t _size{};
+        std::uint16_t _index{};
+    };
+
+    template <
+        std::size_t Buffer_Size = 64 * 1024,
+        unsigned char Buffer_Count_As_Pow2 = 6,
+        unsigned Batch_Size = 1>
+    requires (Buffer_Size % 4096 == 0 && Buffer_Count_As_Pow2 >= 6 && Buffer_Count_As_Pow2 <= 14 && Batch_Size > 0)
+    class Uring_Executor {
+        using continuation_t = std::function<void(int)>;
+        static constexpr std::size_t _BUFFER_COUNT = pow2_size<Buffer_Count_As_Pow2>;
+        static constexpr std::uint64_t _WAKE_UP = 0;
+
+        struct Operation {
+            continuation_t _continuation;
+        };
+
+        // the raw syscalls
+        static int uring_setup(unsigned entries, io_uring_params* params) noexcept {
+            return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) noexcept {
+            return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        static int uring_register(int fd, unsigned opcode, const void* arg, unsigned count) noexcept {
+            return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+        }
+
+        template <typename U>
+        static U* at(void* ring, std::uint32_t offset) noexcept {
+            return reinterpret_cast<U*>(static_cast<unsigned char*>(ring) + offset);
+        }
+
+        [[noreturn]] static void fail(int error, const char* what) {
+            throw std::system_error(error, std::generic_category(), what);
+        }
+
+        void map_rings() {
+            const std::size_t sq_size = _params.sq_off.array + _params.sq_entries * sizeof(std::uint32_t);
+            const std::size_t cq_size = _params.cq_off.cqes + _params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = _params.features & IORING_FEAT_SINGLE_MMAP;
+            _sq_ring_size = single ? std::max(sq_size, cq_size) : sq_size;
+            _sq_ring = mmap(
+                nullptr, _sq_ring_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+            if (_sq_ring == MAP_FAILED) fail(errno, "Uring_Executor: mmap of the SQ ring");
+            if (single) _cq_ring = _sq_ring;
+            else {
+                _cq_ring_size = cq_size;
+                _cq_ring = mmap(
+                    nullptr, _cq_ring_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+                if (_cq_ring == MAP_FAILED) fail(errno, "Uring_Executor: mmap of the CQ ring");
+            }
+            _sqes_size = _params.sq_entries * sizeof(io_uring_sqe);
+            _sqes = static_cast<io_uring_sqe*>(mmap(
+                nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+            if (_sqes == MAP_FAILED) fail(errno, "Uring_Executor: mmap of the SQEs");
+
+            _sq_head = at<std::uint32_t>(_sq_ring, _params.sq_off.head);
+            _sq_tail = at<std::uint32_t>(_sq_ring, _params.sq_off.tail);
+            _sq_mask = *at<std::uint32_t>(_sq_ring, _params.sq_off.ring_mask);
+            _cq_head = at<std::uint32_t>(_cq_ring, _params.cq_off.head);
+            _cq_tail = at<std::uint32_t>(_cq_ring, _params.cq_off.tail);
+            _cq_mask = *at<std::uint32_t>(_cq_ring, _params.cq_off.ring_mask);
+            _cqes = at<io_uring_cqe>(_cq_ring, _params.cq_off.cqes);
+
+            // the identity mapping of the SQ array
+            auto* array = at<std::uint32_t>(_sq_ring, _params.sq_off.array);
+            for (std::uint32_t i = 0; i < _params.sq_entries; ++i) array[i] = i;
+        }
+
+        void unmap_rings() noexcept {
+            if (_sqes && _sqes != MAP_FAILED) munmap(_sqes, _sqes_size);
+            if (_cq_ring && _cq_ring != MAP_FAILED && _cq_ring != _sq_ring) munmap(_cq_ring, _cq_ring_size);
+            if (_sq_ring && _sq_ring != MAP_FAILED) munmap(_sq_ring, _sq_ring_size);
+            if (_fd >= 0) close(_fd);
+        }
+
+        // carve the buffers out of the arena and register them
+        void register_buffers() {
+            iovec iovecs[_BUFFER_COUNT];
+            for (std::size_t i = 0; i < _BUFFER_COUNT; ++i) {
+                _buffers[i] = _arena->allocate(Buffer_Size);
+                iovecs[i] = iovec{ _buffers[i], Buffer_Size };
+            }
+            _buffers_registered =
+                uring_register(_fd, IORING_REGISTER_BUFFERS, iovecs, _BUFFER_COUNT) == 0;
+        }
+
+        // submit the pending SQEs (_sq_m is held)
+        void flush_locked() noexcept {
+            while (_pending > 0) {
+                const int submitted = uring_enter(_fd, _pending, 0, 0);
+                if (submitted >= 0) { _pending -= static_cast<unsigned>(submitted); continue; }
+                if (errno == EINTR) continue;
+                break; // e.g. EBUSY (the CQ backlog): retried by the reaper
+            }
+        }
+
+        // Steps 2 to 4 of the submission (fill sets the fields of the zeroed SQE)
+        template <typename Fill>
+        void submit(std::uint64_t user_data, Fill&& fill) {
+            std::scoped_lock lk(_sq_m);
+
+            // Step 2
+            const std::uint32_t tail = *_sq_tail;
+            while (tail - std::atomic_ref(*_sq_head).load(std::memory_order_acquire) == _params.sq_entries) {
+                flush_locked();
+                if (tail - std::atomic_ref(*_sq_head).load(std::memory_order_acquire) == _params.sq_entries)
+                    std::this_thread::yield(); // the kernel is busy (EBUSY)
+            }
+
+            // Step 3
+            io_uring_sqe& sqe = _sqes[tail & _sq_mask];
+            std::memset(&sqe, 0, sizeof(sqe));
+            fill(sqe);
+            sqe.user_data = user_data;
+            std::atomic_ref(*_sq_tail).store(tail + 1, std::memory_order_release);
+            ++_pending;
+
+            // Step 4
+            if (_pending >= Batch_Size || user_data == _WAKE_UP) flush_locked();
+        }
+
+        // Step 1 of the submission
+        template <typename Fill>
+        void submit_operation(continuation_t continuation, Fill&& fill) {
+            auto* operation = new Operation{ std::move(continuation) };
+            _in_flight.fetch_add(1, std::memory_order_relaxed);
+            try {
+                submit(reinterpret_cast<std::uint64_t>(operation), std::forward<Fill>(fill));
+            }
+            catch (...) {
+                _in_flight.fetch_sub(1, std::memory_order_relaxed);
+                delete operation;
+                throw;
+            }
+        }
+
+        void dispatch(std::uint64_t user_data, int result) noexcept {
+            if (user_data == _WAKE_UP) return;
+            auto* operation = reinterpret_cast<Operation*>(user_data);
+            try {
+                _pool->submit([operation, result] {
+                    operation->_continuation(result);
+                    delete operation;
+                });
+            }
+            catch (...) {
+                // the pool cannot queue the continuation: run inline
+                operation->_continuation(result);
+                delete operation;
+            }
+            _in_flight.fetch_sub(1, std::memory_order_release);
+        }
+
+        void reap() noexcept {
+            while (true) {
+                // Step 1
+                if (uring_enter(_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EBUSY)
+                    std::this_thread::yield();
+
+                // Step 2: the lock also orders the submitters (the operations) before the dispatch
+                {
+                    std::scoped_lock lk(_sq_m);
+                    flush_locked();
+                }
+
+                // Step 3
+                std::uint32_t head = *_cq_head;
+                const std::uint32_t tail = std::atomic_ref(*_cq_tail).load(std::memory_order_acquire);
+                for (; head != tail; ++head) {
+                    const io_uring_cqe& cqe = _cqes[head & _cq_mask];
+                    dispatch(cqe.user_data, cqe.res);
+                }
+                std::atomic_ref(*_cq_head).store(head, std::memory_order_release);
+
+                // Step 4
+                if (_stopping.load(std::memory_order_acquire) &&
+                    _in_flight.load(std::memory_order_acquire) == 0) return;
+            }
+        }
+
+    public:
+
+        // entries: the size of the submission ring (rounded up to a power of two by the kernel)
+        // throws std::system_error if io_uring is not available (e.g. ENOSYS or EPERM by seccomp)
+        explicit Uring_Executor(IThread_Pool& pool, unsigned entries = 256)
+            : _pool(&pool), _arena(std::make_unique<Simple_Static_Arena<Buffer_Size * _BUFFER_COUNT, 4096>>())
+        {
+            _fd = uring_setup(entries, &_params);
+            if (_fd < 0) fail(errno, "Uring_Executor: io_uring_setup");
+            try {
+                map_rings();
+                register_buffers();
+                _reaper = std::thread([this] { reap(); });
+            }
+            catch (...) {
+                unmap_rings();
+                throw;
+            }
+        }
+
+        // Single-threaded context expected (no concurrent submission).
+        // Waits for the operations in flight (their continuations are submitted to the pool).
+        ~Uring_Executor() {
+            _stopping.store(true, std::memory_order_release);
+            submit(_WAKE_UP, [](io_uring_sqe& sqe) { sqe.opcode = IORING_OP_NOP; });
+            _reaper.join();
+            unmap_rings();
+        }
+
+        // Non-copyable/movable for simplicity
+        Uring_Executor(const Uring_Executor&) = delete;
+        Uring_Executor& operator=(const Uring_Executor&) = delete;
+        Uring_Executor(Uring_Executor&&) = delete;
+        Uring_Executor& operator=(Uring_Executor&&) = delete;
+
+        void read(int fd, void* data, unsigned size, std::uint64_t offset, continuation_t continuation) {
+            submit_operation(std::move(continuation), [&](io_uring_sqe& sqe) {
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(data);
+                sqe.len = size;
+                sqe.off = offset;
+            });
+        }
+
+        void write(int fd, const void* data, unsigned size, std::uint64_t offset, continuation_t continuation) {
+            submit_operation(std::move(continuation), [&](io_uring_sqe& sqe) {
+                sqe.opcode = IORING_OP_WRITE;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(data);
+                sqe.len = size;
+                sqe.off = offset;
+            });
+        }
+
+        // read into a registered buffer (size <= Buffer_Size)
+        void read_fixed(int fd, Uring_Buffer buffer, unsigned size, std::uint64_t offset, continuation_t continuation) {
+            submit_operation(std::move(continuation), [&](io_uring_sqe& sqe) {
+                sqe.opcode = _buffers_registered ? IORING_OP_READ_FIXED : IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer._data);
+                sqe.len = size < buffer._size ? size : static_cast<unsigned>(buffer._size);
+                sqe.off = offset;
+                sqe.buf_index = buffer._index;
+            });
+        }
+
+        // write from a registered buffer (size <= Buffer_Size)
+        void write_fixed(int fd, Uring_Buffer buffer, unsigned size, std::uint64_t offset, continuation_t continuation) {
+            submit_operation(std::move(continuation), [&](io_uring_sqe& sqe) {
+                sqe.opcode = _buffers_registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+                sqe.fd = fd;
+                sqe.addr = reinterpret_cast<std::uint64_t>(buffer._data);
+                sqe.len = size < buffer._size ? size : static_cast<unsigned>(buffer._size);
+                sqe.off = offset;
+                sqe.buf_index = buffer._index;
+            });
+        }
+
+        void fsync(int fd, continuation_t continuation) {
+            submit_operation(std::move(continuation), [&](io_uring_sqe& sqe) {
+                sqe.opcode = IORING_OP_FSYNC;
+                sqe.fd = fd;
+            });
+        }
+
+        // submit the pending SQEs (see Cautions 1)
+        void flush() {
+            std::scoped_lock lk(_sq_m);
+            flush_locked();
+        }
+
+        // returns std::nullopt if all registered buffers are in use
+        std::optional<Uring_Buffer> acquire_buffer() noexcept {
+            const auto index = _buffer_ids.allocate();
+            if (!index) return std::nullopt;
+            return Uring_Buffer{ _buffers[*index], Buffer_Size, static_cast<std::uint16_t>(*index) };
+        }
+
+        void release_buffer(Uring_Buffer buffer) noexcept {
+            _buffer_ids.deallocate(buffer._index);
+        }
+
+        // false if the registration failed (the fixed operations fall back, see Notes 1)
+        bool buffers_registered() const noexcept { return _buffers_registered; }
+
+        std::size_t in_flight() const noexcept {
+            return _in_flight.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        // MEMBERS:
+        // _pending is guarded by _sq_m.
+        IThread_Pool* const _pool;
+        std::unique_ptr<Simple_Static_Arena<Buffer_Size * _BUFFER_COUNT, 4096>> _arena;
+        std::byte* _buffers[_BUFFER_COUNT]{};
+        Bitmap_Allocator<Buffer_Count_As_Pow2> _buffer_ids;
+        bool _buffers_registered{ false };
+        int _fd{ -1 };
+        io_uring_params _params{};
+        void* _sq_ring{};
+        void* _cq_ring{};
+        std::size_t _sq_ring_size{};
+        std::size_t _cq_ring_size{};
+        io_uring_sqe* _sqes{};
+        std::size_t _sqes_size{};
+        std::uint32_t* _sq_head{};
+        std::uint32_t* _sq_tail{};
+        std::uint32_t _sq_mask{};
+        std::uint32_t* _cq_head{};
+        std::uint32_t* _cq_tail{};
+        std::uint32_t _cq_mask{};
+        io_uring_cqe* _cqes{};
+        unsigned _pending{};
+        std::mutex _sq_m;
+        std::atomic<std::size_t> _in_flight{ 0 };
+        std::atomic<bool> _stopping{ false };
+        std::thread _reaper;
+    };
+} // namespace BA_Concurrency
+
+#endif // URING_EXECUTOR_HPP